@@ -0,0 +1,90 @@
+#include <cmath>
+#include <cstdio>
+#include "benchmark.h"
+#include "circle_list.h"
+#include "polygon_ring.h"
+
+
+namespace
+{
+    typedef dyb::polygon_ring<double, 2> polygon;
+    typedef polygon::point point;
+
+    void print_row(const char * kernel, double ring_secs, double list_secs, double result)
+    {
+        std::printf("%14s %14.2f %20.2f %10.2f   (%g)\n", kernel, ring_secs * 1000, list_secs * 1000,
+            list_secs / ring_secs, result);
+    }
+}
+
+// polygon_ring kernels against the same computation with dyb::for_adjacent over circular_list<point>,
+// on a polygon of 2^20 vertices, every kernel is repeated and the total time is printed.
+void bench_polygon_ring()
+{
+    const int n = 1 << 20, repeat = 20;
+    polygon ring;
+    dyb::circular_list<point> cl;
+    ring.reserve(n);
+    for (int i = 0; i < n; i++)
+    {
+        double r = i % 2 ? 1.0 : 1.1, a = i * 2 * 3.14159265358979 / n;
+        point p = { { r * std::cos(a), r * std::sin(a) } };
+        ring.push_back(p);
+        cl.insert(cl.end(), p);
+    }
+    const point inside = { { 0.25, 0.5 } };
+    // read through volatile pointers, so that the repeated kernels are not merged into one call
+    const polygon * volatile ring_ptr = &ring;
+    const dyb::circular_list<point> * volatile list_ptr = &cl;
+
+    std::printf("\npolygon_ring, %d vertices, %d runs\n%14s %14s %20s %10s\n", n, repeat,
+        "kernel", "polygon_ring ms", "circular_list ms", "ratio");
+
+    double ring_result = 0, list_result = 0;
+    double ring_secs = bench::seconds([&]{
+        for (int r = 0; r < repeat; r++) ring_result += ring_ptr->signed_area();
+    });
+    double list_secs = bench::seconds([&]{
+        for (int r = 0; r < repeat; r++)
+        {
+            double sum = 0;
+            dyb::for_adjacent(list_ptr->loop_begin(), list_ptr->loop_end(), [&sum](const point & a, const point & b){
+                sum += a[0] * b[1] - b[0] * a[1];
+            });
+            list_result += sum / 2;
+        }
+    });
+    print_row("signed_area", ring_secs, list_secs, ring_result - list_result);
+
+    ring_result = list_result = 0;
+    ring_secs = bench::seconds([&]{
+        for (int r = 0; r < repeat; r++) ring_result += ring_ptr->perimeter();
+    });
+    list_secs = bench::seconds([&]{
+        for (int r = 0; r < repeat; r++)
+        {
+            dyb::for_adjacent(list_ptr->loop_begin(), list_ptr->loop_end(), [&list_result](const point & a, const point & b){
+                list_result += std::sqrt((b[0] - a[0]) * (b[0] - a[0]) + (b[1] - a[1]) * (b[1] - a[1]));
+            });
+        }
+    });
+    print_row("perimeter", ring_secs, list_secs, ring_result - list_result);
+
+    int ring_inside = 0, list_inside = 0;
+    ring_secs = bench::seconds([&]{
+        for (int r = 0; r < repeat; r++) ring_inside += ring_ptr->contains(inside);
+    });
+    list_secs = bench::seconds([&]{
+        for (int r = 0; r < repeat; r++)
+        {
+            int crossings = 0;
+            dyb::for_adjacent(list_ptr->loop_begin(), list_ptr->loop_end(), [&crossings, &inside](const point & a, const point & b){
+                if ((a[1] > inside[1]) != (b[1] > inside[1])
+                    && inside[0] < a[0] + (inside[1] - a[1]) * (b[0] - a[0]) / (b[1] - a[1]))
+                    ++crossings;
+            });
+            list_inside += crossings & 1;
+        }
+    });
+    print_row("contains", ring_secs, list_secs, ring_inside - list_inside);
+}
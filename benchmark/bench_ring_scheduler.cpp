@@ -0,0 +1,34 @@
+#include <atomic>
+#include "benchmark.h"
+#include "ring_scheduler.h"
+
+
+// Throughput of ring_scheduler with 1, 2, 4 ... 64 workers.
+// All the queues are submitted to worker 0, so every other worker only gets work by stealing.
+void bench_ring_scheduler()
+{
+    const int queue_count = 1024, queue_len = 64;
+    const unsigned work = 2000;
+    std::atomic<unsigned> sink(0);
+    bench::print_header("ring_scheduler, all queues on worker 0", "tasks/s");
+    double base = 0;
+    for (size_t threads : bench::thread_counts())
+    {
+        dyb::ring_scheduler scheduler(threads);
+        double secs = bench::seconds([&]{
+            for (int i = 0; i < queue_count; i++)
+            {
+                dyb::ring_scheduler::task_queue queue;
+                for (int j = 0; j < queue_len; j++)
+                {
+                    unsigned seed = i * queue_len + j;
+                    queue.push_back([&sink, seed]{ sink += bench::spin(work, seed) & 1; });
+                }
+                scheduler.submit(queue, 0);
+            }
+            scheduler.wait();
+        });
+        double rate = bench::print_row(threads, secs, double(queue_count) * queue_len, base);
+        if (base == 0) base = rate;
+    }
+}
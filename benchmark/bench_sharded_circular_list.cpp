@@ -0,0 +1,52 @@
+#include <thread>
+#include <vector>
+#include "benchmark.h"
+#include "sharded_circular_list.h"
+
+
+namespace
+{
+    // every thread runs ops_per_thread operations on a list of 1024 elements per shard,
+    // one insert into its local shard for three next()
+    double run(size_t threads, size_t shard_count, int ops_per_thread)
+    {
+        dyb::sharded_circular_list<int> scl(shard_count);
+        for (size_t s = 0; s < shard_count; s++)
+            for (int i = 0; i < 1024; i++)
+                scl.insert(i, s);
+        return bench::seconds([&]{
+            std::vector<std::thread> workers;
+            for (size_t t = 0; t < threads; t++)
+            {
+                workers.emplace_back([&scl, ops_per_thread]{
+                    int n = 0;
+                    for (int i = 0; i < ops_per_thread; i++)
+                    {
+                        if (i % 4 == 0) scl.insert(i);
+                        else scl.next(n);
+                    }
+                });
+            }
+            for (auto & w : workers) w.join();
+        });
+    }
+}
+
+// Throughput of insert() and next() with 1, 2, 4 ... 64 threads,
+// with as many shards as threads, then with a single shard (one mutex for the whole ring).
+void bench_sharded_circular_list()
+{
+    const int ops_per_thread = 200000;
+    const char * names[] = { "sharded_circular_list, one shard per thread", "sharded_circular_list, single shard" };
+    for (int single = 0; single < 2; single++)
+    {
+        bench::print_header(names[single], "ops/s");
+        double base = 0;
+        for (size_t threads : bench::thread_counts())
+        {
+            double secs = run(threads, single ? 1 : threads, ops_per_thread);
+            double rate = bench::print_row(threads, secs, double(threads) * ops_per_thread, base);
+            if (base == 0) base = rate;
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef DYB_BENCHMARK
+#define DYB_BENCHMARK
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+
+// helpers shared by the bench_*.cpp files,
+// every benchmark prints one line per configuration on stdout
+
+
+namespace bench
+{
+    // the thread counts of the scaling benchmarks: 1, 2, 4 ... 64,
+    // counts above the number of hardware threads are run too (oversubscribed)
+    inline std::vector<size_t> thread_counts()
+    {
+        std::vector<size_t> counts;
+        for (size_t n = 1; n <= 64; n *= 2)
+            counts.push_back(n);
+        return counts;
+    }
+
+    // wall clock seconds spent in func
+    template<class Func>
+    double seconds(Func func)
+    {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // about n cycles of work the optimizer can not drop
+    inline unsigned spin(unsigned n, unsigned seed)
+    {
+        for (unsigned i = 0; i < n; i++)
+            seed = seed * 1664525u + 1013904223u;
+        return seed;
+    }
+
+    inline void print_header(const char * name, const char * unit)
+    {
+        std::printf("\n%s\n%8s %12s %16s %10s\n", name, "threads", "ms", unit, "speedup");
+    }
+
+    // speedup is the throughput relative to base_rate, the first row passes 0 and gets 1,
+    // return the throughput of this row
+    inline double print_row(size_t threads, double secs, double ops, double base_rate)
+    {
+        double rate = ops / secs;
+        std::printf("%8u %12.2f %16.0f %10.2f\n", static_cast<unsigned>(threads), secs * 1000, rate,
+            base_rate == 0 ? 1.0 : rate / base_rate);
+        return rate;
+    }
+}
+
+#endif
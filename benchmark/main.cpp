@@ -0,0 +1,36 @@
+#include <cstdio>
+#include <cstring>
+#include "benchmark.h"
+
+void bench_polygon_ring();
+void bench_ring_scheduler();
+void bench_sharded_circular_list();
+
+namespace
+{
+    struct entry
+    {
+        const char * name;
+        void (*run)();
+    };
+
+    const entry benchmarks[] = {
+        { "polygon_ring", bench_polygon_ring },
+        { "ring_scheduler", bench_ring_scheduler },
+        { "sharded_circular_list", bench_sharded_circular_list },
+    };
+}
+
+// usage: benchmark [name ...]
+// run the named benchmarks, or all of them when no name is given
+int main(int argc, char * argv[])
+{
+    for (auto & b : benchmarks)
+    {
+        bool selected = argc == 1;
+        for (int i = 1; i < argc; i++)
+            selected = selected || std::strcmp(argv[i], b.name) == 0;
+        if (selected) b.run();
+    }
+    return 0;
+}
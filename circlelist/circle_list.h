@@ -6,6 +6,7 @@
 #include <functional>
 #include <algorithm>
 #include <iterator>
+#include <array>
 
 #include "debug.h"
 
@@ -43,6 +44,21 @@
 // It will not stop the loop immediately after called when _start == _terminal,
 // but will stop when iter try to access the _start for the second time.
 
+// deferred erase :
+// By default circular_list::erase unlinks and deletes the node at once,
+// which invalidates every iterator pointing to it.
+// With set_deferred_erase(true), erase only marks the node as dead:
+// it stays linked and allocated, size() no longer counts it,
+// and both iterators as well as the customed algorithms skip it,
+// so an iterator to an erased node can still be incremented (it moves to the next live node)
+// or used as the bound of a loop range (it stands for the next live node).
+// compact() unlinks and deletes all the dead nodes in a single lap,
+// it is called automatically when the number of dead nodes reaches the compact threshold (0 means never),
+// when the last live node is erased, and when deferred erase is turned off.
+// Iterators to dead nodes are invalidated by compact().
+// Copies and moves take the erase mode and threshold of the source,
+// and splice frees the dead nodes it moves into a circular_list without deferred erase.
+
 
 namespace dyb
 {
@@ -52,18 +68,44 @@ namespace dyb
     struct double_linked_list_node
     {
         EleType _ele;
+        bool dead; // erased but not yet compacted, see deferred erase
         double_linked_list_node * prev, *next;
         double_linked_list_node(const EleType & element)
-            : _ele(element), prev(nullptr), next(nullptr)
+            : _ele(element), dead(false), prev(nullptr), next(nullptr)
         {
         }
     };
 
-    template<class EleType, bool is_const>
+    // node of forward_circular_list, the iterators only need next
+    template<class EleType>
+    struct singly_linked_list_node
+    {
+        EleType _ele;
+        singly_linked_list_node * next;
+        singly_linked_list_node(const EleType & element)
+            : _ele(element), next(nullptr)
+        {
+        }
+    };
+
+    // used by the iterators to skip the nodes erased in deferred mode
+    template<class EleType>
+    bool is_dead(const double_linked_list_node<EleType> * p)
+    {
+        return p->dead;
+    }
+
+    template<class EleType>
+    bool is_dead(const singly_linked_list_node<EleType> *)
+    {
+        return false;
+    }
+
+    template<class EleType, bool is_const, class Node = double_linked_list_node<EleType>>
     class common_iterator : public std::iterator<std::forward_iterator_tag, EleType>
     {
     public:
-        typedef double_linked_list_node<EleType> node;
+        typedef Node node;
         // both const and non const
         typedef typename std::conditional<is_const, const EleType, EleType>::type cncEleType;
         typedef typename std::conditional<is_const, const node, node>::type cncNode;
@@ -81,17 +123,15 @@ namespace dyb
         common_iterator & operator ++ ()
         {
             CHECKNULL(_ptr);
-            if (_ptr->next == _head) _ptr = nullptr;
-            else _ptr = _ptr->next;
+            do _ptr = _ptr->next; while (_ptr != _head && is_dead(_ptr));
+            if (_ptr == _head) _ptr = nullptr;
             return *this;
         }
 
         common_iterator operator ++ (int)
         {
-            CHECKNULL(_ptr);
             common_iterator temp(*this);
-            if (_ptr->next == _head) _ptr = nullptr;
-            else _ptr = _ptr->next;
+            ++*this;
             return temp;
         }
 
@@ -122,18 +162,18 @@ namespace dyb
             return _ptr;
         }
 
-        friend class common_iterator<EleType, true>;
+        friend class common_iterator<EleType, true, Node>;
 
     private:
         node * _ptr;
         const node * _head;
     };
 
-    template<class EleType, bool is_const>
+    template<class EleType, bool is_const, class Node = double_linked_list_node<EleType>>
     class loop_iterator : public std::iterator<std::forward_iterator_tag, EleType>
     {
     public:
-        typedef double_linked_list_node<EleType> node;
+        typedef Node node;
         // both const and non const
         typedef typename std::conditional<is_const, const EleType, EleType>::type cncEleType;
         typedef typename std::conditional<is_const, const node, node>::type cncNode;
@@ -150,18 +190,24 @@ namespace dyb
         loop_iterator & operator ++ () // should not be called when _ptr == nullptr
         {
             CHECKNULL(_ptr);
-            _ptr = _ptr->next;
+            do _ptr = _ptr->next; while (is_dead(_ptr));
             return *this;
         }
 
         loop_iterator operator++ (int)
         {
-            CHECKNULL(_ptr);
-            node * temp = _ptr;
-            _ptr = _ptr->next;
+            loop_iterator temp(*this);
+            ++*this;
             return temp;
         }
 
+        // move to the first live node starting from the current one, see deferred erase
+        loop_iterator & skip_dead()
+        {
+            while (_ptr != nullptr && is_dead(_ptr)) _ptr = _ptr->next;
+            return *this;
+        }
+
         bool operator == (loop_iterator other)
         {
             return _ptr == other._ptr;
@@ -188,41 +234,41 @@ namespace dyb
             return _ptr;
         }
 
-        friend class loop_iterator<EleType, true>;
+        friend class loop_iterator<EleType, true, Node>;
 
     private:
         node * _ptr;
     };
 
     // comparasion between common_iterator and loop_iterator
-    template<class EleType, bool common_iter_is_const, bool loop_iter_is_const>
+    template<class EleType, bool common_iter_is_const, bool loop_iter_is_const, class Node>
     bool operator == (
-        const common_iterator<EleType, common_iter_is_const> & lhs,
-        const loop_iterator<EleType, loop_iter_is_const> & rhs)
+        const common_iterator<EleType, common_iter_is_const, Node> & lhs,
+        const loop_iterator<EleType, loop_iter_is_const, Node> & rhs)
     {
         return lhs.get() == rhs.get();
     }
 
-    template<class EleType, bool common_iter_is_const, bool loop_iter_is_const>
+    template<class EleType, bool common_iter_is_const, bool loop_iter_is_const, class Node>
     bool operator == (
-        const loop_iterator<EleType, loop_iter_is_const> & lhs,
-        const common_iterator<EleType, common_iter_is_const> & rhs)
+        const loop_iterator<EleType, loop_iter_is_const, Node> & lhs,
+        const common_iterator<EleType, common_iter_is_const, Node> & rhs)
     {
         return rhs == lhs;
     }
 
-    template<class EleType, bool common_iter_is_const, bool loop_iter_is_const>
+    template<class EleType, bool common_iter_is_const, bool loop_iter_is_const, class Node>
     bool operator != (
-        const common_iterator<EleType, common_iter_is_const> & lhs,
-        const loop_iterator<EleType, loop_iter_is_const> & rhs)
+        const common_iterator<EleType, common_iter_is_const, Node> & lhs,
+        const loop_iterator<EleType, loop_iter_is_const, Node> & rhs)
     {
         return lhs.get() != rhs.get();
     }
 
-    template<class EleType, bool common_iter_is_const, bool loop_iter_is_const>
+    template<class EleType, bool common_iter_is_const, bool loop_iter_is_const, class Node>
     bool operator != (
-        const loop_iterator<EleType, loop_iter_is_const> & lhs,
-        const common_iterator<EleType, common_iter_is_const> & rhs)
+        const loop_iterator<EleType, loop_iter_is_const, Node> & lhs,
+        const common_iterator<EleType, common_iter_is_const, Node> & rhs)
     {
         return rhs != lhs;
     }
@@ -251,7 +297,8 @@ namespace dyb
 
         // since const iterator is not implemented so use non const reference
         circular_list(const circular_list & other)
-            : head(nullptr), _size(other._size)
+            : head(nullptr), _size(other._size),
+            _deferred(other._deferred), _compact_threshold(other._compact_threshold)
         {
             for (auto & ele : other)
             {
@@ -261,10 +308,12 @@ namespace dyb
 
         // move constructor
         circular_list(circular_list && other)
-            : head(other.head), _size(other._size)
+            : head(other.head), _size(other._size), _dead(other._dead),
+            _deferred(other._deferred), _compact_threshold(other._compact_threshold)
         {
             other.head = nullptr;
             other._size = 0;
+            other._dead = 0;
         }
 
         circular_list & operator = (const circular_list & other)
@@ -272,6 +321,8 @@ namespace dyb
             DEBUGCHECK(this != &other, "assignment to self");
             clear();
             _size = other._size;
+            _deferred = other._deferred;
+            _compact_threshold = other._compact_threshold;
             for (auto & ele : other)
             {
                 insert(nullptr, ele);
@@ -288,6 +339,10 @@ namespace dyb
             other.head = nullptr;
             _size = other._size;
             other._size = 0;
+            _dead = other._dead;
+            other._dead = 0;
+            _deferred = other._deferred;
+            _compact_threshold = other._compact_threshold;
             return *this;
         }
 
@@ -300,6 +355,13 @@ namespace dyb
         {
             return common_iter(head, insert(location.get(), element));
         }
+        // link the whole range [first, last) before location in one splice,
+        // return the first inserted element or location if the range is empty
+        template<class InputIt>
+        common_iter insert(common_iter location, InputIt first, InputIt last)
+        {
+            return common_iter(head, insert(location.get(), first, last));
+        }
         common_iter erase(common_iter location)
         {
             return common_iter(head, erase(location.get()));
@@ -310,13 +372,26 @@ namespace dyb
         }
         bool exist(common_iter iter)
         {
-            return exist(iter.get());
+            return exist(iter.get()) && !iter.get()->dead;
         }
 
         loop_iter insert(loop_iter location, const EleType & element)
         {
             return loop_iter(insert(location.get(), element));
         }
+        template<class InputIt>
+        loop_iter insert(loop_iter location, InputIt first, InputIt last)
+        {
+            return loop_iter(insert(location.get(), first, last));
+        }
+        // Move the loop range [first, last) of other before location without reallocating,
+        // first == last moves the whole of other. location can be null loop_iter when this is empty.
+        // The dead nodes of the range are moved as well, and freed unless this uses deferred erase.
+        // Return the first live moved element, or location when none is live.
+        loop_iter splice(loop_iter location, circular_list & other, loop_iter first, loop_iter last)
+        {
+            return loop_iter(splice(location.get(), other, first.get(), last.get()));
+        }
         loop_iter erase(loop_iter location)
         {
             return loop_iter(erase(location.get()));
@@ -327,8 +402,55 @@ namespace dyb
         }
         bool exist(loop_iter iter)
         {
-            return exist(iter.get());
+            return exist(iter.get()) && !iter.get()->dead;
+        }
+
+        // Unlink every element satisfying pred in a single lap and return the number erased.
+        // Unlike a find_if/erase loop, no exist() check is run per erased node.
+        size_t erase_if(function<bool(const EleType & e)> pred)
+        {
+            if (head == nullptr) return 0;
+            size_t erased = erase_if(head, head, pred);
+            settle();
+            return erased;
+        }
+        // same as above but restricted to the loop range [first, last),
+        // first == last means a whole lap starting from first
+        size_t erase_if(loop_iter first, loop_iter last, function<bool(const EleType & e)> pred)
+        {
+            DEBUGCHECK(exist(first.get()), "invalid first pointer");
+            DEBUGCHECK(exist(last.get()), "invalid last pointer");
+            CHECKNULL(pred);
+            size_t erased = erase_if(first.skip_dead().get(), last.skip_dead().get(), pred);
+            settle();
+            return erased;
         }
+        // Call func on every element of the loop range [first, last),
+        // the current node is erased when func returns true.
+        // Iterators to other nodes stay valid.
+        template<class Function>
+        Function for_each_erase(loop_iter first, loop_iter last, Function func)
+        {
+            DEBUGCHECK(exist(first.get()), "invalid first pointer");
+            DEBUGCHECK(exist(last.get()), "invalid last pointer");
+            erase_if(first.skip_dead().get(), last.skip_dead().get(), func);
+            settle();
+            return std::move(func);
+        }
+
+        // deferred erase
+        // compact_threshold: compact automatically once that many nodes are dead, 0 means never
+        void set_deferred_erase(bool enable, size_t compact_threshold = 0)
+        {
+            _deferred = enable;
+            _compact_threshold = compact_threshold;
+            if (!enable) compact();
+            else settle();
+        }
+        bool deferred_erase() const { return _deferred; }
+        // unlink and delete all the dead nodes in one lap, return the number of them
+        size_t compact();
+        size_t dead_count() const { return _dead; }
 
         void clear()
         {
@@ -341,7 +463,9 @@ namespace dyb
                 p = p->next;
                 delete temp;
             }
+            head = nullptr;
             _size = 0;
+            _dead = 0;
         }
         size_t size() const { return _size; }
         common_iter begin() { return common_iter(head, head); }
@@ -357,14 +481,41 @@ namespace dyb
         circular_list() = default;
 
     private:
+        // links nodes next to its finger without the existence check
+        template<class, class> friend class ordered_circular_list;
+        // links and splices next to the cursors of its workers without the existence check
+        friend class ring_scheduler;
+        // links and splices next to the cursors of its shards without the existence check
+        template<class> friend class sharded_circular_list;
+
         node * insert(node * location, const EleType & element);
+        template<class InputIt>
+        node * insert(node * location, InputIt first, InputIt last);
+        node * splice(node * location, circular_list & other, node * first, node * last);
+        // splice without the existence checks, only walks the moved range
+        node * transfer(node * location, circular_list & other, node * first, node * last);
+        // link the open chain [chain_head, chain_tail] of count nodes before location,
+        // location == nullptr appends to the tail
+        void link(node * location, node * chain_head, node * chain_tail, int count);
         node * erase(node * location);
+        template<class Pred>
+        size_t erase_if(node * first, node * last, Pred & pred);
+        // unlink location from the ring and free it, location must be in the circular_list
+        void unlink(node * location);
+        // unlink location, or only mark it as dead in deferred mode
+        void discard(node * location);
+        // restore the invariants broken by discard: free the ring when no live node is left,
+        // keep head on a live node, and compact when the threshold is reached
+        void settle();
         // return nullptr when not found
         node * find_if(node * _begin, node * _end, function<bool(const EleType &)> pred);
         bool exist(node * p_node);
 
         node * head = nullptr;
-        int _size = 0;
+        int _size = 0; // live nodes
+        int _dead = 0;
+        bool _deferred = false;
+        size_t _compact_threshold = 0;
     };
 
     template<class EleType>
@@ -415,15 +566,214 @@ namespace dyb
     {
         DEBUGCHECK(head != nullptr, "circular_list::erase: erase a node on a empty circular_list");
         DEBUGCHECK(exist(location), "circular_list::erase: location is not in the circular_list");
+        DEBUGCHECK(!location->dead, "circular_list::erase: location has already been erased");
         typename circular_list<EleType>::node * next = location->next;
+        discard(location);
+        if (_size == 0)
+        {
+            settle();
+            return nullptr;
+        }
+        while (next->dead) next = next->next;
+        settle();
+        return next;
+    }
+
+    template<class EleType>
+    void circular_list<EleType>::discard(typename circular_list<EleType>::node * location)
+    {
+        if (!_deferred)
+        {
+            unlink(location);
+            return;
+        }
+        location->dead = true;
+        --_size;
+        ++_dead;
+    }
+
+    template<class EleType>
+    void circular_list<EleType>::settle()
+    {
+        if (head == nullptr) return;
+        if (_size == 0)
+        {
+            clear();
+            return;
+        }
+        while (head->dead) head = head->next;
+        if (_compact_threshold != 0 && static_cast<size_t>(_dead) >= _compact_threshold)
+            compact();
+    }
+
+    template<class EleType>
+    size_t circular_list<EleType>::compact()
+    {
+        // head is always live here, so it stops the lap
+        if (_dead == 0) return 0;
+        typename circular_list<EleType>::node * p = head->next;
+        while (p != head)
+        {
+            typename circular_list<EleType>::node * next = p->next;
+            if (p->dead)
+            {
+                p->prev->next = next;
+                next->prev = p->prev;
+                delete p;
+            }
+            p = next;
+        }
+        size_t freed = _dead;
+        _dead = 0;
+        return freed;
+    }
+
+    template<class EleType>
+    void circular_list<EleType>::unlink(typename circular_list<EleType>::node * location)
+    {
         location->prev->next = location->next;
         location->next->prev = location->prev;
         --_size;
         if (_size == 0) head = nullptr;
         else if (head == location) head = head->next;
         delete location;
-        if (_size == 0) return nullptr;
-        else return next;
+    }
+
+    template<class EleType>
+    template<class InputIt>
+    typename circular_list<EleType>::node * circular_list<EleType>::insert(
+        typename circular_list<EleType>::node * location, InputIt first, InputIt last)
+    {
+        typedef typename circular_list<EleType>::node _MyNode;
+        DEBUGCHECK(head != nullptr || location == nullptr,
+            "circular_list::insert: circular_list is empty but location is not nullptr");
+        DEBUGCHECK(location == nullptr || exist(location),
+            "circular_list::insert: location is not in the circular_list");
+        if (first == last) return location;
+        // build an open chain first, then splice it into the ring
+        _MyNode * chain_head = new _MyNode(*first);
+        _MyNode * chain_tail = chain_head;
+        int count = 1;
+        for (++first; first != last; ++first)
+        {
+            _MyNode * p = new _MyNode(*first);
+            chain_tail->next = p;
+            p->prev = chain_tail;
+            chain_tail = p;
+            ++count;
+        }
+        link(location, chain_head, chain_tail, count);
+        return chain_head;
+    }
+
+    template<class EleType>
+    typename circular_list<EleType>::node * circular_list<EleType>::splice(
+        typename circular_list<EleType>::node * location, circular_list & other,
+        typename circular_list<EleType>::node * first,
+        typename circular_list<EleType>::node * last)
+    {
+        DEBUGCHECK(this != &other, "circular_list::splice: splice from self");
+        DEBUGCHECK(head != nullptr || location == nullptr,
+            "circular_list::splice: circular_list is empty but location is not nullptr");
+        DEBUGCHECK(location == nullptr || exist(location),
+            "circular_list::splice: location is not in the circular_list");
+        DEBUGCHECK(other.exist(first), "invalid first pointer");
+        DEBUGCHECK(other.exist(last), "invalid last pointer");
+        return transfer(location, other, first, last);
+    }
+
+    template<class EleType>
+    typename circular_list<EleType>::node * circular_list<EleType>::transfer(
+        typename circular_list<EleType>::node * location, circular_list & other,
+        typename circular_list<EleType>::node * first,
+        typename circular_list<EleType>::node * last)
+    {
+        typedef typename circular_list<EleType>::node _MyNode;
+        _MyNode * chain_tail = last->prev;
+        _MyNode * first_live = nullptr;
+        int count = 0, dead = 0;
+        bool contains_head = false;
+        _MyNode * p = first;
+        do
+        {
+            if (p == other.head) contains_head = true;
+            if (p->dead) ++dead;
+            else if (first_live == nullptr) first_live = p;
+            p = p->next;
+            ++count;
+        } while (p != last);
+        // cut the chain out of other
+        if (count == other._size + other._dead)
+        {
+            other.head = nullptr;
+        }
+        else
+        {
+            first->prev->next = last;
+            last->prev = first->prev;
+            if (contains_head) other.head = last;
+        }
+        other._size -= count - dead;
+        other._dead -= dead;
+        link(location, first, chain_tail, count - dead);
+        _dead += dead;
+        other.settle();
+        settle();
+        if (!_deferred) compact();
+        return first_live == nullptr ? location : first_live;
+    }
+
+    template<class EleType>
+    void circular_list<EleType>::link(
+        typename circular_list<EleType>::node * location,
+        typename circular_list<EleType>::node * chain_head,
+        typename circular_list<EleType>::node * chain_tail,
+        int count)
+    {
+        typedef typename circular_list<EleType>::node _MyNode;
+        if (head == nullptr)
+        {
+            chain_tail->next = chain_head;
+            chain_head->prev = chain_tail;
+            head = chain_head;
+            _size = count;
+            return;
+        }
+        _MyNode * right = location == nullptr ? head : location;
+        _MyNode * left = right->prev;
+        left->next = chain_head;
+        chain_head->prev = left;
+        chain_tail->next = right;
+        right->prev = chain_tail;
+        _size += count;
+        if (head == location)
+            head = chain_head;
+    }
+
+    // work for loop_iterator, first == last means a whole lap
+    template<class EleType>
+    template<class Pred>
+    size_t circular_list<EleType>::erase_if(
+        typename circular_list<EleType>::node * first,
+        typename circular_list<EleType>::node * last,
+        Pred & pred)
+    {
+        // the number of nodes in the range is unknown but never exceeds _size + _dead,
+        // which also stops a whole lap whose first node has been erased
+        size_t remaining = _size + _dead;
+        size_t erased = 0;
+        typename circular_list<EleType>::node * p = first;
+        do
+        {
+            typename circular_list<EleType>::node * next = p->next;
+            if (!p->dead && pred(p->_ele))
+            {
+                discard(p);
+                ++erased;
+            }
+            p = next;
+        } while (--remaining != 0 && p != last);
+        return erased;
     }
 
     // work for loop_iterator
@@ -437,9 +787,11 @@ namespace dyb
         DEBUGCHECK(exist(first), "invalid first pointer");
         DEBUGCHECK(exist(last), "invalid last pointer");
         CHECKNULL(pred);
+        while (first->dead) first = first->next;
+        while (last->dead) last = last->next;
         do
         {
-            if (pred(first->_ele)) return first;
+            if (!first->dead && pred(first->_ele)) return first;
             first = first->next;
         } while (first != last);
         return nullptr;
@@ -460,12 +812,14 @@ namespace dyb
 
 
     // customed algorithm for loop_iterator
-    template<class EleType, class Pred, bool is_const>
-    typename loop_iterator<EleType, is_const> adjacent_find(
-        loop_iterator<EleType, is_const> first, 
-        loop_iterator<EleType, is_const> last,
+    template<class EleType, class Pred, bool is_const, class Node>
+    loop_iterator<EleType, is_const, Node> adjacent_find(
+        loop_iterator<EleType, is_const, Node> first, 
+        loop_iterator<EleType, is_const, Node> last,
         Pred pred)
     {
+        first.skip_dead();
+        last.skip_dead();
         auto next = first; ++next;
         do
         {
@@ -474,15 +828,17 @@ namespace dyb
             ++first;
             ++next;
         } while (first != last);
-        return loop_iterator<EleType, is_const>(nullptr);
+        return loop_iterator<EleType, is_const, Node>(nullptr);
     }
 
-    template<class EleType, class Function, bool is_const>
+    template<class EleType, class Function, bool is_const, class Node>
     Function for_each(
-        loop_iterator<EleType, is_const> first,
-        loop_iterator<EleType, is_const> last,
+        loop_iterator<EleType, is_const, Node> first,
+        loop_iterator<EleType, is_const, Node> last,
         Function func)
     {
+        first.skip_dead();
+        last.skip_dead();
         do
         {
             func(*first);
@@ -491,12 +847,14 @@ namespace dyb
         return std::move(func);
     }
 
-    template<class EleType, class Function, bool is_const>
+    template<class EleType, class Function, bool is_const, class Node>
     Function for_adjacent(
-        loop_iterator<EleType, is_const> first,
-        loop_iterator<EleType, is_const> last,
+        loop_iterator<EleType, is_const, Node> first,
+        loop_iterator<EleType, is_const, Node> last,
         Function func)
     {
+        first.skip_dead();
+        last.skip_dead();
         auto next = first; ++next;
         do
         {
@@ -507,6 +865,121 @@ namespace dyb
         return std::move(func);
     }
 
+    // Call func(window_first, window_last) for every element of the loop range [first, last),
+    // where [window_first, window_last) is the loop range of the k elements starting from it.
+    // The window wraps around the ring and both of its ends move one node per step.
+    // window_first == window_last when k equals the size of the circular_list,
+    // k should not be greater than that.
+    // Moving the window costs O(1) per step, but func walking [window_first, window_last) costs O(k) per call.
+    // Use window_reduce for an incremental reduction over the window,
+    // or for_window<k> to get the k elements without walking the nodes again.
+    template<class EleType, class Function, bool is_const, class Node>
+    Function for_window(
+        loop_iterator<EleType, is_const, Node> first,
+        loop_iterator<EleType, is_const, Node> last,
+        size_t k,
+        Function func)
+    {
+        first.skip_dead();
+        last.skip_dead();
+        DEBUGCHECK(k > 0, "for_window: empty window");
+        auto window_last = first;
+        for (size_t i = 0; i < k; i++) ++window_last;
+        do
+        {
+            func(first, window_last);
+            ++first;
+            ++window_last;
+        } while (first != last);
+        return std::move(func);
+    }
+
+    namespace detail
+    {
+        // unpack a circular window buffer, from its oldest element, into the arguments of func
+        template<size_t remaining>
+        struct window_invoker
+        {
+            template<class Function, class Buffer, class... Args>
+            static void call(Function & func, const Buffer & window, size_t oldest, Args &... args)
+            {
+                const size_t k = std::tuple_size<Buffer>::value;
+                window_invoker<remaining - 1>::call(func, window, oldest, args..., *window[(oldest + sizeof...(Args)) % k]);
+            }
+        };
+
+        template<>
+        struct window_invoker<0>
+        {
+            template<class Function, class Buffer, class... Args>
+            static void call(Function & func, const Buffer &, size_t, Args &... args)
+            {
+                func(args...);
+            }
+        };
+    }
+
+    // Same as above, but func is called with the k elements of the window,
+    // so for_window<2> behaves like for_adjacent.
+    // The window keeps pointers to its elements in a circular buffer,
+    // one node is visited and one pointer is replaced per step.
+    template<size_t k, class EleType, class Function, bool is_const, class Node>
+    Function for_window(
+        loop_iterator<EleType, is_const, Node> first,
+        loop_iterator<EleType, is_const, Node> last,
+        Function func)
+    {
+        first.skip_dead();
+        last.skip_dead();
+        static_assert(k > 0, "for_window: empty window");
+        typedef typename loop_iterator<EleType, is_const, Node>::cncEleType cncEleType;
+        std::array<cncEleType *, k> window;
+        auto window_last = first;
+        for (size_t i = 0; i < k; i++, ++window_last)
+            window[i] = &*window_last;
+        size_t oldest = 0;
+        do
+        {
+            detail::window_invoker<k>::call(func, window, oldest);
+            window[oldest] = &*window_last;
+            if (++oldest == k) oldest = 0;
+            ++first;
+            ++window_last;
+        } while (first != last);
+        return std::move(func);
+    }
+
+    // Write to out the reduction of the k-wide window starting from every element of the loop range [first, last).
+    // The first window is built from init with add(acc, element),
+    // after that the window slides with one remove(acc, leaving_element) and one add(acc, entering_element).
+    template<class EleType, class T, class Add, class Remove, class OutputIt, bool is_const, class Node>
+    OutputIt window_reduce(
+        loop_iterator<EleType, is_const, Node> first,
+        loop_iterator<EleType, is_const, Node> last,
+        size_t k,
+        T init,
+        Add add,
+        Remove remove,
+        OutputIt out)
+    {
+        first.skip_dead();
+        last.skip_dead();
+        DEBUGCHECK(k > 0, "window_reduce: empty window");
+        auto window_last = first;
+        for (size_t i = 0; i < k; i++, ++window_last)
+            init = add(init, *window_last);
+        while (true)
+        {
+            *out = init;
+            ++out;
+            auto leaving = first++;
+            if (first == last) break;
+            init = add(remove(init, *leaving), *window_last);
+            ++window_last;
+        }
+        return out;
+    }
+
 }
 
 #endif
@@ -0,0 +1,292 @@
+#ifndef DYB_FORWARD_CIRCULAR_LIST
+#define DYB_FORWARD_CIRCULAR_LIST
+
+#include <initializer_list>
+#include <functional>
+#include <algorithm>
+
+#include "circle_list.h"
+#include "debug.h"
+
+
+// forward_circular_list is the singly linked version of circular_list.
+// A node only stores next, and the list stores the tail instead of the head,
+// so head is always tail->next and both ends can be reached in O(1).
+// It uses the same common_iterator and loop_iterator (instantiated with singly_linked_list_node),
+// so everything said about them in circle_list.h also holds here,
+// and the customed algorithms for loop_iterator (for_each, for_adjacent, for_window...) work as well.
+
+// Without prev a node can not be unlinked or inserted before by itself,
+// so the positional operations are insert_after and erase_after.
+
+
+namespace dyb
+{
+    using std::function;
+
+    template<class EleType>
+    class forward_circular_list
+    {
+    public:
+        typedef singly_linked_list_node<EleType> node;
+        typedef common_iterator<EleType, false, node> iterator;
+        typedef common_iterator<EleType, true, node> const_iterator;
+        typedef common_iterator<EleType, false, node> common_iter;
+        typedef common_iterator<EleType, true, node> const_common_iter;
+        typedef loop_iterator<EleType, false, node> loop_iter;
+        typedef loop_iterator<EleType, true, node> const_loop_iter;
+
+        forward_circular_list() = default;
+
+        forward_circular_list(std::initializer_list<EleType> _initList)
+        {
+            for (auto & ele : _initList)
+            {
+                push_back(ele);
+            }
+        }
+
+        forward_circular_list(const forward_circular_list & other)
+        {
+            for (auto & ele : other)
+            {
+                push_back(ele);
+            }
+        }
+
+        forward_circular_list(forward_circular_list && other)
+            : tail(other.tail), _size(other._size)
+        {
+            other.tail = nullptr;
+            other._size = 0;
+        }
+
+        forward_circular_list & operator = (const forward_circular_list & other)
+        {
+            DEBUGCHECK(this != &other, "assignment to self");
+            clear();
+            for (auto & ele : other)
+            {
+                push_back(ele);
+            }
+            return *this;
+        }
+
+        forward_circular_list & operator = (forward_circular_list && other)
+        {
+            DEBUGCHECK(this != &other, "assignment to self");
+            clear();
+            tail = other.tail;
+            other.tail = nullptr;
+            _size = other._size;
+            other._size = 0;
+            return *this;
+        }
+
+        ~forward_circular_list()
+        {
+            clear();
+        }
+
+        void push_back(const EleType & element)
+        {
+            tail = link_after(tail, new node(element));
+        }
+        void push_front(const EleType & element)
+        {
+            link_after(tail, new node(element));
+        }
+        void pop_front()
+        {
+            DEBUGCHECK(tail != nullptr, "forward_circular_list::pop_front: pop a node on a empty forward_circular_list");
+            unlink_after(tail);
+        }
+        EleType & front() { CHECKNULL(tail); return tail->next->_ele; }
+        EleType & back() { CHECKNULL(tail); return tail->_ele; }
+        const EleType & front() const { CHECKNULL(tail); return tail->next->_ele; }
+        const EleType & back() const { CHECKNULL(tail); return tail->_ele; }
+
+        // location can be end() only when the forward_circular_list is empty
+        common_iter insert_after(common_iter location, const EleType & element)
+        {
+            node * p = insert_after(location.get(), element);
+            return common_iter(head(), p);
+        }
+        // return the element after the erased one, or end() when the tail has been erased
+        common_iter erase_after(common_iter location)
+        {
+            bool erase_tail = location.get() != nullptr && location.get()->next == tail;
+            node * next = erase_after(location.get());
+            return common_iter(head(), erase_tail ? nullptr : next);
+        }
+        common_iter find_if(common_iter _begin, common_iter _end, function<bool(const EleType & e)> pred)
+        {
+            return std::find_if(_begin, _end, pred);
+        }
+        bool exist(common_iter iter)
+        {
+            return exist(iter.get());
+        }
+
+        // location can be null loop_iter only when the forward_circular_list is empty
+        loop_iter insert_after(loop_iter location, const EleType & element)
+        {
+            return loop_iter(insert_after(location.get(), element));
+        }
+        // return the element after the erased one, or null loop_iter when the forward_circular_list becomes empty
+        loop_iter erase_after(loop_iter location)
+        {
+            return loop_iter(erase_after(location.get()));
+        }
+        loop_iter find_if(loop_iter _begin, loop_iter _end, function<bool(const EleType & e)> pred)
+        {
+            return loop_iter(find_if(_begin.get(), _end.get(), pred));
+        }
+        bool exist(loop_iter iter)
+        {
+            return exist(iter.get());
+        }
+
+        void clear()
+        {
+            if (tail == nullptr) return;
+            node * p = tail->next;
+            tail->next = nullptr;
+            while (p != nullptr)
+            {
+                node * temp = p;
+                p = p->next;
+                delete temp;
+            }
+            tail = nullptr;
+            _size = 0;
+        }
+        size_t size() const { return _size; }
+        common_iter begin() { return common_iter(head(), head()); }
+        common_iter end() { return common_iter(head(), nullptr); }
+        const_common_iter begin() const { return const_common_iter(head(), head()); }
+        const_common_iter end() const { return const_common_iter(head(), nullptr); }
+
+        loop_iter loop_begin() { return loop_iter(head()); }
+        loop_iter loop_end() { return loop_iter(head()); }
+        const_loop_iter loop_begin() const { return const_loop_iter(head()); }
+        const_loop_iter loop_end() const { return const_loop_iter(head()); }
+        // the node immediately before loop_begin()
+        loop_iter loop_tail() { return loop_iter(tail); }
+        const_loop_iter loop_tail() const { return const_loop_iter(tail); }
+
+    private:
+        node * head() const { return tail == nullptr ? nullptr : tail->next; }
+        // no existence check, return p
+        node * link_after(node * location, node * p);
+        // no existence check, location must not be nullptr, return the node after the erased one
+        node * unlink_after(node * location);
+        node * insert_after(node * location, const EleType & element);
+        node * erase_after(node * location);
+        // return nullptr when not found
+        node * find_if(node * _begin, node * _end, function<bool(const EleType &)> pred);
+        bool exist(node * p_node);
+
+        node * tail = nullptr;
+        int _size = 0;
+    };
+
+    template<class EleType>
+    typename forward_circular_list<EleType>::node * forward_circular_list<EleType>::link_after(
+        typename forward_circular_list<EleType>::node * location,
+        typename forward_circular_list<EleType>::node * p)
+    {
+        if (tail == nullptr)
+        {
+            p->next = p;
+            tail = p;
+        }
+        else
+        {
+            p->next = location->next;
+            location->next = p;
+        }
+        ++_size;
+        return p;
+    }
+
+    template<class EleType>
+    typename forward_circular_list<EleType>::node * forward_circular_list<EleType>::unlink_after(
+        typename forward_circular_list<EleType>::node * location)
+    {
+        typename forward_circular_list<EleType>::node * p = location->next;
+        --_size;
+        if (_size == 0)
+        {
+            tail = nullptr;
+            delete p;
+            return nullptr;
+        }
+        location->next = p->next;
+        if (p == tail) tail = location;
+        delete p;
+        return location->next;
+    }
+
+    template<class EleType>
+    typename forward_circular_list<EleType>::node * forward_circular_list<EleType>::insert_after(
+        typename forward_circular_list<EleType>::node * location, const EleType & element)
+    {
+        if (tail == nullptr)
+        {
+            DEBUGCHECK(location == nullptr,
+                "forward_circular_list::insert_after: forward_circular_list is empty but location is not nullptr");
+        }
+        else
+        {
+            DEBUGCHECK(exist(location), "forward_circular_list::insert_after: location is not in the forward_circular_list");
+        }
+        typename forward_circular_list<EleType>::node * p =
+            link_after(location, new typename forward_circular_list<EleType>::node(element));
+        if (location == tail) tail = p;
+        return p;
+    }
+
+    template<class EleType>
+    typename forward_circular_list<EleType>::node * forward_circular_list<EleType>::erase_after(
+        typename forward_circular_list<EleType>::node * location)
+    {
+        DEBUGCHECK(tail != nullptr, "forward_circular_list::erase_after: erase a node on a empty forward_circular_list");
+        DEBUGCHECK(exist(location), "forward_circular_list::erase_after: location is not in the forward_circular_list");
+        return unlink_after(location);
+    }
+
+    // work for loop_iterator
+    template<class EleType>
+    typename forward_circular_list<EleType>::node * forward_circular_list<EleType>::find_if(
+        typename forward_circular_list<EleType>::node * first,
+        typename forward_circular_list<EleType>::node * last,
+        function<bool(const EleType &)> pred)
+    {
+        // precondition: both first and last point to a node of the same forward_circular_list
+        DEBUGCHECK(exist(first), "invalid first pointer");
+        DEBUGCHECK(exist(last), "invalid last pointer");
+        CHECKNULL(pred);
+        do
+        {
+            if (pred(first->_ele)) return first;
+            first = first->next;
+        } while (first != last);
+        return nullptr;
+    }
+
+    template<class EleType>
+    bool forward_circular_list<EleType>::exist(typename forward_circular_list<EleType>::node * p_node)
+    {
+        if (tail == nullptr) return false;
+        typename forward_circular_list<EleType>::node * p = tail;
+        do
+        {
+            if (p == p_node) return true;
+            p = p->next;
+        } while (p != tail);
+        return false;
+    }
+}
+
+#endif
@@ -2,7 +2,18 @@
 #include <iostream>
 #include <list>
 #include <iterator>
+#include <cmath>
+#include <sstream>
+#include <cstdio>
+#include <vector>
+#include <atomic>
 #include "circle_list.h"
+#include "ring_scheduler.h"
+#include "sharded_circular_list.h"
+#include "forward_circular_list.h"
+#include "polygon_ring.h"
+#include "ordered_circular_list.h"
+#include "ring_serialization.h"
 #include "debug.h"
 
 using std::cout;
@@ -13,6 +24,7 @@ using std::begin;
 using std::end;
 using dyb::debugCheck;
 using dyb::circular_list;
+using dyb::forward_circular_list;
 
 #define TEST(expression) DEBUGCHECK(expression, "test failed")
 
@@ -165,6 +177,219 @@ void test_erase_loop_iter()
     TEST(cl.size() == 0);
 }
 
+circular_list<int>::loop_iter cl_find(circular_list<int> & cl, int value)
+{
+    return cl.find_if(cl.loop_begin(), cl.loop_end(), [value](int n){ return n == value; });
+}
+
+void test_insert_range()
+{
+    cout << "test_insert_range" << endl;
+    circular_list<int> cl;
+    list<int> src = { 1, 2 };
+    cl.insert(end(cl), begin(src), end(src));
+    TEST(cl.size() == 2);
+    TEST(equal(begin(cl), end(cl), begin({ 1, 2 })));
+
+    src = { -1, 0 };
+    TEST(*cl.insert(begin(cl), begin(src), end(src)) == -1);
+    TEST(cl.size() == 4);
+    TEST(equal(begin(cl), end(cl), begin({ -1, 0, 1, 2 })));
+
+    src = { 3, 4 };
+    cl.insert(end(cl), begin(src), end(src));
+    TEST(cl.size() == 6);
+    TEST(equal(begin(cl), end(cl), begin({ -1, 0, 1, 2, 3, 4 })));
+
+    auto pos = cl.find_if(cl.loop_begin(), cl.loop_end(), [](int n){ return n == 1; });
+    int arr[] = { 7, 8 };
+    TEST(*cl.insert(pos, begin(arr), end(arr)) == 7);
+    TEST(cl.size() == 8);
+    TEST(equal(begin(cl), end(cl), begin({ -1, 0, 7, 8, 1, 2, 3, 4 })));
+
+    src.clear();
+    TEST(cl.insert(pos, begin(src), end(src)) == pos);
+    TEST(cl.size() == 8);
+}
+
+void test_erase_if()
+{
+    cout << "test_erase_if" << endl;
+    circular_list<int> cl = { 0, 1, 2, 3, 4, 5 };
+    TEST(cl.erase_if([](int n){ return n % 2 == 0; }) == 3);
+    TEST(cl.size() == 3);
+    TEST(equal(begin(cl), end(cl), begin({ 1, 3, 5 })));
+    TEST(cl.erase_if([](int n){ return n > 9; }) == 0);
+    TEST(cl.size() == 3);
+    TEST(cl.erase_if([](int){ return true; }) == 3);
+    TEST(cl.size() == 0);
+    TEST(cl.erase_if([](int){ return true; }) == 0);
+}
+
+void test_erase_if_loop_iter()
+{
+    cout << "test_erase_if_loop_iter" << endl;
+    circular_list<int> cl = { 0, 1, 2, 3, 4, 5 };
+    auto first = cl.find_if(cl.loop_begin(), cl.loop_end(), [](int n){ return n == 4; });
+    auto last = cl.find_if(cl.loop_begin(), cl.loop_end(), [](int n){ return n == 2; });
+    // range wraps around: 4, 5, 0, 1
+    TEST(cl.erase_if(first, last, [](int n){ return n % 2 == 0; }) == 2);
+    TEST(cl.size() == 4);
+    TEST(equal(begin(cl), end(cl), begin({ 1, 2, 3, 5 })));
+
+    // a whole lap which erases first
+    first = cl.find_if(cl.loop_begin(), cl.loop_end(), [](int n){ return n == 3; });
+    TEST(cl.erase_if(first, first, [](int n){ return n != 2; }) == 3);
+    TEST(cl.size() == 1);
+    TEST(equal(begin(cl), end(cl), begin({ 2 })));
+}
+
+void test_for_each_erase()
+{
+    cout << "test_for_each_erase" << endl;
+    circular_list<int> cl = { 0, 1, 2, 3 };
+    auto kept = ++cl.loop_begin();
+    int visited = 0;
+    cl.for_each_erase(cl.loop_begin(), cl.loop_end(), [&visited](int & n){
+        ++visited;
+        ++n;
+        return n % 2 != 0;
+    });
+    TEST(visited == 4);
+    TEST(cl.size() == 2);
+    TEST(equal(begin(cl), end(cl), begin({ 2, 4 })));
+    TEST(*kept == 2);
+    TEST(kept == cl.loop_begin());
+}
+
+void test_splice()
+{
+    cout << "test_splice" << endl;
+    circular_list<int> a = { 0, 1, 2, 3, 4 };
+    circular_list<int> b = { 9 };
+    auto first = cl_find(a, 3);
+    auto last = cl_find(a, 1);
+    // the range wraps around and contains the head of a
+    TEST(*b.splice(b.loop_begin(), a, first, last) == 3);
+    TEST(equal(begin(a), end(a), begin({ 1, 2 })));
+    TEST(a.size() == 2);
+    TEST(equal(begin(b), end(b), begin({ 3, 4, 0, 9 })));
+    TEST(b.size() == 4);
+
+    circular_list<int> c;
+    c.splice(c.loop_begin(), b, b.loop_begin(), b.loop_begin());
+    TEST(b.size() == 0);
+    TEST(equal(begin(b), end(b), begin(list<int>{})));
+    TEST(c.size() == 4);
+    TEST(equal(begin(c), end(c), begin({ 3, 4, 0, 9 })));
+}
+
+void test_deferred_erase()
+{
+    cout << "test_deferred_erase" << endl;
+    circular_list<int> cl = { 0, 1, 2, 3, 4 };
+    cl.set_deferred_erase(true);
+    auto held = cl_find(cl, 2);
+    auto head = cl.loop_begin();
+
+    TEST(*cl.erase(held) == 3);
+    TEST(cl.size() == 4);
+    TEST(cl.dead_count() == 1);
+    TEST(!cl.exist(held));
+    TEST(equal(begin(cl), end(cl), begin({ 0, 1, 3, 4 })));
+    // the held iterator still works and moves to the next live node
+    TEST(*++circular_list<int>::loop_iter(held) == 3);
+
+    // erase the head
+    TEST(*cl.erase(head) == 1);
+    TEST(*cl.loop_begin() == 1);
+    TEST(equal(begin(cl), end(cl), begin({ 1, 3, 4 })));
+    TEST(cl.dead_count() == 2);
+
+    // dead bounds stand for the next live node
+    std::vector<int> values;
+    dyb::for_each(held, held, [&values](int n){ values.push_back(n); });
+    TEST(equal(begin(values), end(values), begin({ 3, 4, 1 })));
+    TEST(*cl.find_if(held, head, [](int n){ return n > 3; }) == 4);
+    TEST(cl.find_if(head, head, [](int n){ return n == 2; }) == end(cl));
+    values.clear();
+    dyb::for_adjacent(cl.loop_begin(), cl.loop_end(), [&values](int curr, int next){
+        values.push_back(curr * 10 + next);
+    });
+    TEST(equal(begin(values), end(values), begin({ 13, 34, 41 })));
+
+    TEST(cl.erase_if([](int n){ return n == 3; }) == 1);
+    TEST(cl.dead_count() == 3);
+    TEST(cl.compact() == 3);
+    TEST(cl.dead_count() == 0);
+    TEST(cl.size() == 2);
+    TEST(equal(begin(cl), end(cl), begin({ 1, 4 })));
+
+    // erasing the last live node frees the whole ring
+    cl.erase(cl.loop_begin());
+    cl.erase(cl.loop_begin());
+    TEST(cl.size() == 0);
+    TEST(cl.dead_count() == 0);
+    TEST(begin(cl) == end(cl));
+    cl.insert(end(cl), 5);
+    TEST(equal(begin(cl), end(cl), begin({ 5 })));
+}
+
+void test_deferred_erase_threshold()
+{
+    cout << "test_deferred_erase_threshold" << endl;
+    circular_list<int> cl = { 0, 1, 2, 3, 4, 5 };
+    cl.set_deferred_erase(true, 2);
+    cl.erase(cl.loop_begin());
+    TEST(cl.dead_count() == 1);
+    cl.erase(cl.loop_begin());
+    TEST(cl.dead_count() == 0);
+    TEST(equal(begin(cl), end(cl), begin({ 2, 3, 4, 5 })));
+
+    cl.erase(cl.loop_begin());
+    TEST(cl.dead_count() == 1);
+    // dead nodes are moved by splice as well
+    circular_list<int> other;
+    other.set_deferred_erase(true);
+    other.splice(other.loop_begin(), cl, cl.loop_begin(), cl.loop_begin());
+    TEST(cl.size() == 0);
+    TEST(cl.dead_count() == 0);
+    TEST(other.size() == 3);
+    TEST(other.dead_count() == 1);
+    TEST(equal(begin(other), end(other), begin({ 3, 4, 5 })));
+
+    // and freed when the receiving list does not defer erase,
+    // the returned element is the first live one even if the range starts with a dead node
+    auto dead_first = other.loop_begin();
+    other.erase(dead_first);
+    circular_list<int> plain;
+    TEST(*plain.splice(plain.loop_begin(), other, dead_first, dead_first) == 4);
+    TEST(other.size() == 0);
+    TEST(plain.size() == 2);
+    TEST(plain.dead_count() == 0);
+    TEST(equal(begin(plain), end(plain), begin({ 4, 5 })));
+
+    // assignments take the erase mode of the source, like the constructors
+    circular_list<int> source = { 0, 1, 2 };
+    source.set_deferred_erase(true);
+    source.erase(cl_find(source, 1));
+    plain = source;
+    TEST(plain.deferred_erase());
+    TEST(plain.dead_count() == 0);
+    TEST(equal(begin(plain), end(plain), begin({ 0, 2 })));
+    plain.erase(plain.loop_begin());
+    TEST(plain.dead_count() == 1);
+    cl = std::move(source);
+    TEST(cl.deferred_erase());
+    TEST(cl.dead_count() == 1);
+    TEST(equal(begin(cl), end(cl), begin({ 0, 2 })));
+
+    // turning deferred erase off compacts
+    cl.set_deferred_erase(false);
+    TEST(cl.dead_count() == 0);
+    TEST(equal(begin(cl), end(cl), begin({ 0, 2 })));
+}
+
 // helper function
 void test_constructor_operator()
 {
@@ -289,6 +514,577 @@ void test_for_adjacent()
     });
 }
 
+void test_for_window()
+{
+    cout << "test_for_window" << endl;
+    circular_list<int> cl = { 0, 1, 2, 3 };
+    std::vector<int> sums;
+    dyb::for_window(cl.loop_begin(), cl.loop_end(), 3,
+        [&sums](circular_list<int>::loop_iter first, circular_list<int>::loop_iter last){
+        int sum = 0;
+        do
+        {
+            sum += *first;
+            ++first;
+        } while (first != last);
+        sums.push_back(sum);
+    });
+    TEST(equal(begin(sums), end(sums), begin({ 3, 6, 5, 4 })));
+
+    // the window covers the whole ring
+    sums.clear();
+    dyb::for_window(cl.loop_begin(), cl.loop_end(), 4,
+        [&sums](circular_list<int>::loop_iter first, circular_list<int>::loop_iter last){
+        TEST(first == last);
+        sums.push_back(*first);
+    });
+    TEST(equal(begin(sums), end(sums), begin({ 0, 1, 2, 3 })));
+}
+
+void test_for_window_fixed()
+{
+    cout << "test_for_window_fixed" << endl;
+    circular_list<int> cl = { 0, 1, 2, 3 };
+    std::vector<int> values;
+    dyb::for_window<3>(cl.loop_begin(), cl.loop_end(), [&values](int a, int b, int c){
+        values.push_back(a * 100 + b * 10 + c);
+    });
+    TEST(equal(begin(values), end(values), begin({ 12, 123, 230, 301 })));
+
+    dyb::for_window<1>(cl.loop_begin(), cl.loop_end(), [](int & n){ n *= 2; });
+    TEST(equal(begin(cl), end(cl), begin({ 0, 2, 4, 6 })));
+
+    // loop range which does not start from head
+    values.clear();
+    auto first = ++cl.loop_begin();
+    auto last = ++(++(++cl.loop_begin()));
+    dyb::for_window<2>(first, last, [&values](int a, int b){ values.push_back(a * 10 + b); });
+    TEST(equal(begin(values), end(values), begin({ 24, 46 })));
+
+    // the window as large as the ring, its circular buffer wraps on every step
+    values.clear();
+    dyb::for_window<4>(cl.loop_begin(), cl.loop_end(), [&values](int a, int b, int c, int d){
+        values.push_back(a * 1000 + b * 100 + c * 10 + d);
+    });
+    TEST(equal(begin(values), end(values), begin({ 246, 2460, 4602, 6024 })));
+}
+
+void test_window_reduce()
+{
+    cout << "test_window_reduce" << endl;
+    circular_list<int> cl = { 0, 1, 2, 3, 4 };
+    std::vector<int> sums;
+    auto add = [](int acc, int n){ return acc + n; };
+    auto remove = [](int acc, int n){ return acc - n; };
+    dyb::window_reduce(cl.loop_begin(), cl.loop_end(), 2, 0, add, remove, std::back_inserter(sums));
+    TEST(equal(begin(sums), end(sums), begin({ 1, 3, 5, 7, 4 })));
+
+    sums.clear();
+    dyb::window_reduce(cl.loop_begin(), cl.loop_end(), 5, 0, add, remove, std::back_inserter(sums));
+    TEST(equal(begin(sums), end(sums), begin({ 10, 10, 10, 10, 10 })));
+}
+
+// ring_scheduler
+void test_ring_scheduler_round_robin()
+{
+    cout << "test_ring_scheduler_round_robin" << endl;
+    std::vector<int> order;
+    std::atomic<bool> gate(false);
+    {
+        dyb::ring_scheduler scheduler(1);
+        // hold the only worker so that both queues are in the ring before dispatching starts
+        scheduler.submit([&gate]{ while (!gate) std::this_thread::yield(); });
+        scheduler.submit({ [&]{ order.push_back(0); }, [&]{ order.push_back(2); } });
+        scheduler.submit({ [&]{ order.push_back(1); }, [&]{ order.push_back(3); } });
+        gate = true;
+        scheduler.wait();
+    }
+    TEST(equal(begin(order), end(order), begin({ 0, 1, 2, 3 })));
+}
+
+void test_ring_scheduler_steal()
+{
+    cout << "test_ring_scheduler_steal" << endl;
+    const int queue_count = 64, queue_len = 16;
+    std::atomic<int> sum(0);
+    dyb::ring_scheduler scheduler(4);
+    // put everything on worker 0, the others have to steal
+    for (int i = 0; i < queue_count; i++)
+    {
+        dyb::ring_scheduler::task_queue queue;
+        for (int j = 0; j < queue_len; j++)
+            queue.push_back([&sum]{ ++sum; });
+        scheduler.submit(queue, 0);
+    }
+    scheduler.wait();
+    TEST(sum == queue_count * queue_len);
+    scheduler.submit([&sum]{ ++sum; });
+    scheduler.wait();
+    TEST(sum == queue_count * queue_len + 1);
+}
+
+void test_ring_scheduler_queue_order()
+{
+    cout << "test_ring_scheduler_queue_order" << endl;
+    const int queue_count = 64, queue_len = 8;
+    // a queue must not be stolen while one of its tasks runs, or its next task could overtake it
+    std::vector<int> last(queue_count, -1);
+    std::vector<std::atomic<int>> running(queue_count);
+    std::atomic<bool> ordered(true);
+    {
+        dyb::ring_scheduler scheduler(4);
+        for (int i = 0; i < queue_count; i++)
+        {
+            running[i] = 0;
+            dyb::ring_scheduler::task_queue queue;
+            for (int j = 0; j < queue_len; j++)
+            {
+                queue.push_back([&, i, j]{
+                    if (running[i]++ != 0 || last[i] != j - 1) ordered = false;
+                    last[i] = j;
+                    std::this_thread::yield();
+                    --running[i];
+                });
+            }
+            scheduler.submit(queue, 0);
+        }
+        scheduler.wait();
+    }
+    TEST(ordered);
+    TEST(std::all_of(begin(last), end(last), [](int j){ return j == queue_len - 1; }));
+}
+
+// sharded_circular_list
+void test_sharded_next()
+{
+    cout << "test_sharded_next" << endl;
+    dyb::sharded_circular_list<int> scl(3);
+    int n = 0;
+    TEST(!scl.next(n));
+    scl.insert(0, 0);
+    scl.insert(1, 0);
+    scl.insert(10, 1);
+    TEST(scl.size() == 3);
+    // the shards take turns from the local shard of this thread, which depends on its id,
+    // but shard 2 is empty and skipped, so shards 0 and 1 alternate whatever the start
+    std::vector<int> values, from_shard0;
+    for (int i = 0; i < 6; i++)
+    {
+        TEST(scl.next(n));
+        values.push_back(n);
+        if (n != 10) from_shard0.push_back(n);
+    }
+    TEST(std::adjacent_find(begin(values), end(values), [](int a, int b){ return (a == 10) == (b == 10); }) == end(values));
+    TEST(equal(begin(from_shard0), end(from_shard0), begin({ 0, 1, 0 })));
+
+    TEST(scl.erase_if([](int v){ return v < 10; }) == 2);
+    TEST(scl.size() == 1);
+    TEST(scl.next(n) && n == 10);
+}
+
+void test_sharded_erase_if_cursor()
+{
+    cout << "test_sharded_erase_if_cursor" << endl;
+    dyb::sharded_circular_list<int> scl(1);
+    for (int i = 0; i < 5; i++) scl.insert(i, 0);
+    int n = 0;
+    TEST(scl.next(n) && n == 0);
+    TEST(scl.next(n) && n == 1);
+    // the cursor is on 2, it moves to its successor instead of restarting the lap
+    int calls = 0;
+    TEST(scl.erase_if([&calls](int v){ ++calls; return v == 2; }) == 1);
+    TEST(calls == 5);
+    TEST(scl.next(n) && n == 3);
+
+    // the cursor is on 4, it and the element after it are erased
+    TEST(scl.erase_if([](int v){ return v == 4 || v == 0; }) == 2);
+    TEST(scl.next(n) && n == 1);
+    TEST(scl.next(n) && n == 3);
+
+    TEST(scl.erase_if([](int){ return true; }) == 2);
+    TEST(scl.size() == 0);
+    TEST(!scl.next(n));
+    scl.insert(7, 0);
+    TEST(scl.next(n) && n == 7);
+}
+
+void test_sharded_rebalance()
+{
+    cout << "test_sharded_rebalance" << endl;
+    dyb::sharded_circular_list<int> scl(4);
+    for (int i = 0; i < 10; i++) scl.insert(i, 0);
+    scl.insert(10, 3);
+    scl.rebalance();
+    TEST(scl.size() == 11);
+    for (size_t i = 0; i < 4; i++)
+        TEST(scl.shard_size(i) == (i < 3 ? 3u : 2u));
+    // every shard gets three turns in 12 calls, wherever the round-robin starts
+    std::vector<bool> seen(11, false);
+    int n = 0;
+    for (int i = 0; i < 12; i++)
+    {
+        TEST(scl.next(n));
+        seen[n] = true;
+    }
+    TEST(std::find(begin(seen), end(seen), false) == end(seen));
+
+    // fewer elements than shards
+    dyb::sharded_circular_list<int> small(4);
+    small.insert(0, 3);
+    small.rebalance();
+    TEST(small.shard_size(0) == 1);
+    TEST(small.shard_size(3) == 0);
+    small.insert(1, 3);
+    TEST(small.size() == 2);
+}
+
+void test_sharded_concurrent_insert()
+{
+    cout << "test_sharded_concurrent_insert" << endl;
+    dyb::sharded_circular_list<int> scl(4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+        threads.emplace_back([&scl]{ for (int i = 0; i < 1000; i++) scl.insert(i); });
+    for (auto & t : threads) t.join();
+    TEST(scl.size() == 4000);
+}
+
+// forward_circular_list
+void test_forward_push_pop()
+{
+    cout << "test_forward_push_pop" << endl;
+    forward_circular_list<int> fl;
+    TEST(fl.size() == 0);
+    TEST(begin(fl) == end(fl));
+    fl.push_back(1);
+    fl.push_back(2);
+    fl.push_front(0);
+    TEST(fl.size() == 3);
+    TEST(equal(begin(fl), end(fl), begin({ 0, 1, 2 })));
+    TEST(fl.front() == 0);
+    TEST(fl.back() == 2);
+    TEST(*fl.loop_tail() == 2);
+    TEST(++fl.loop_tail() == fl.loop_begin());
+
+    fl.pop_front();
+    TEST(equal(begin(fl), end(fl), begin({ 1, 2 })));
+    fl.pop_front();
+    fl.pop_front();
+    TEST(fl.size() == 0);
+    fl.push_front(3);
+    TEST(equal(begin(fl), end(fl), begin({ 3 })));
+    TEST(fl.front() == 3 && fl.back() == 3);
+}
+
+void test_forward_insert_erase_after()
+{
+    cout << "test_forward_insert_erase_after" << endl;
+    forward_circular_list<int> fl;
+    fl.insert_after(fl.loop_begin(), 0);
+    TEST(equal(begin(fl), end(fl), begin({ 0 })));
+    TEST(*fl.insert_after(fl.loop_begin(), 2) == 2);
+    TEST(fl.back() == 2);
+    fl.insert_after(begin(fl), 1);
+    TEST(equal(begin(fl), end(fl), begin({ 0, 1, 2 })));
+    TEST(fl.back() == 2);
+
+    // erase the head through the tail
+    TEST(*fl.erase_after(fl.loop_tail()) == 1);
+    TEST(equal(begin(fl), end(fl), begin({ 1, 2 })));
+    // erase the tail
+    TEST(fl.erase_after(begin(fl)) == end(fl));
+    TEST(equal(begin(fl), end(fl), begin({ 1 })));
+    TEST(fl.back() == 1);
+    TEST(fl.erase_after(fl.loop_begin()) == end(fl));
+    TEST(fl.size() == 0);
+}
+
+void test_forward_iter_algorithm()
+{
+    cout << "test_forward_iter_algorithm" << endl;
+    forward_circular_list<int> fl = { 0, 1, 2, 3 };
+    forward_circular_list<int> copy = fl;
+    TEST(equal(begin(copy), end(copy), begin({ 0, 1, 2, 3 })));
+
+    TEST(*fl.find_if(begin(fl), end(fl), [](int n){ return n > 1; }) == 2);
+    TEST(fl.find_if(begin(fl), end(fl), [](int n){ return n < 0; }) == end(fl));
+    auto it = fl.find_if(fl.loop_tail(), fl.loop_tail(), [](int n){ return n < 2; });
+    TEST(*it == 0);
+    TEST(fl.find_if(fl.loop_begin(), fl.loop_end(), [](int n){ return n < 0; }) == end(fl));
+
+    dyb::for_each(fl.loop_begin(), fl.loop_end(), [](int & n){ ++n; });
+    TEST(equal(begin(fl), end(fl), begin({ 1, 2, 3, 4 })));
+    dyb::for_adjacent(fl.loop_begin(), fl.loop_end(), [](int curr, int next){
+        TEST(curr == 4 ? next == 1 : next == curr + 1);
+    });
+    TEST(*dyb::adjacent_find(fl.loop_begin(), fl.loop_end(), [](int a, int b){ return a > b; }) == 4);
+
+    const forward_circular_list<int> & cfl = fl;
+    int sum = 0;
+    for (auto & n : cfl) sum += n;
+    TEST(sum == 10);
+
+    forward_circular_list<int> moved = std::move(fl);
+    TEST(fl.size() == 0);
+    TEST(moved.size() == 4);
+    fl = moved;
+    TEST(equal(begin(fl), end(fl), begin({ 1, 2, 3, 4 })));
+}
+
+// polygon_ring
+void test_polygon_ring_kernels()
+{
+    cout << "test_polygon_ring_kernels" << endl;
+    typedef dyb::polygon_ring<double, 2> polygon;
+    polygon square = { { 0, 0 }, { 2, 0 }, { 2, 2 }, { 0, 2 } };
+    TEST(square.size() == 4);
+    TEST(square.signed_area() == 4);
+    TEST(square.winding() == 1);
+    TEST(square.perimeter() == 8);
+    TEST(square.vertex(5) == square.vertex(1));
+    TEST(square.contains({ 1, 1 }));
+    TEST(!square.contains({ 3, 1 }));
+    TEST(!square.contains({ 1, -1 }));
+
+    polygon clockwise = { { 0, 0 }, { 0, 2 }, { 2, 2 }, { 2, 0 } };
+    TEST(clockwise.signed_area() == -4);
+    TEST(clockwise.winding() == -1);
+
+    std::array<std::vector<double>, 2> edges;
+    square.edge_vectors(edges);
+    TEST(equal(begin(edges[0]), end(edges[0]), begin({ 2, 0, -2, 0 })));
+    TEST(equal(begin(edges[1]), end(edges[1]), begin({ 0, 2, 0, -2 })));
+    std::vector<double> lengths;
+    square.edge_lengths(lengths);
+    TEST(equal(begin(lengths), end(lengths), begin({ 2, 2, 2, 2 })));
+
+    square.translate({ 1, 1 });
+    square.scale(2);
+    TEST(square.vertex(0) == (polygon::point{ 2, 2 }));
+    TEST(square.signed_area() == 16);
+    TEST(square.contains({ 5, 5 }));
+}
+
+void test_polygon_ring_vs_for_adjacent()
+{
+    cout << "test_polygon_ring_vs_for_adjacent" << endl;
+    typedef dyb::polygon_ring<double, 3> polygon;
+    // star shaped, non convex polygons, the large one spans several blocks of the length kernels
+    for (int n : { 17, 1001 })
+    {
+        polygon ring;
+        circular_list<polygon::point> cl;
+        for (int i = 0; i < n; i++)
+        {
+            double r = i % 2 ? 1.0 : 2.5, a = i * 2 * 3.14159265358979 / n;
+            polygon::point p = { r * std::cos(a), r * std::sin(a), 0.5 * i };
+            ring.push_back(p);
+            cl.insert(end(cl), p);
+        }
+        double area = 0, perimeter = 0;
+        dyb::for_adjacent(cl.loop_begin(), cl.loop_end(),
+            [&](const polygon::point & a, const polygon::point & b){
+            area += a[0] * b[1] - b[0] * a[1];
+            perimeter += std::sqrt((b[0] - a[0]) * (b[0] - a[0])
+                + (b[1] - a[1]) * (b[1] - a[1]) + (b[2] - a[2]) * (b[2] - a[2]));
+        });
+        TEST(std::fabs(ring.signed_area() - area / 2) < 1e-9);
+        TEST(std::fabs(ring.perimeter() - perimeter) < 1e-9 * n);
+        std::vector<double> lengths;
+        ring.edge_lengths(lengths);
+        double sum = 0;
+        for (double l : lengths) sum += l;
+        TEST(std::fabs(sum - perimeter) < 1e-9 * n);
+        TEST(ring.contains({ 0, 0, 0 }));
+        if (n == 17) TEST(!ring.contains({ 2, 0.7, 0 }));
+    }
+}
+
+// ordered_circular_list
+void test_ordered_insert()
+{
+    cout << "test_ordered_insert" << endl;
+    dyb::ordered_circular_list<int> ol = { 5, 1, 4, 2, 3 };
+    TEST(ol.size() == 5);
+    TEST(equal(begin(ol), end(ol), begin({ 1, 2, 3, 4, 5 })));
+    TEST(*ol.finger() == 3);
+
+    // new minimum and maximum through the finger
+    TEST(*ol.insert(0) == 0);
+    TEST(*ol.loop_begin() == 0);
+    ol.insert(9);
+    TEST(equal(begin(ol), end(ol), begin({ 0, 1, 2, 3, 4, 5, 9 })));
+    TEST(*ol.loop_begin() == 0);
+
+    // hint far from the position
+    auto hint = ol.lower_bound(9);
+    ol.insert(circular_list<int>::loop_iter(hint.get()), 1);
+    TEST(equal(begin(ol), end(ol), begin({ 0, 1, 1, 2, 3, 4, 5, 9 })));
+
+    // greater comparator, equal elements keep insertion order
+    typedef std::pair<int, int> item;
+    auto by_first = [](const item & a, const item & b){ return a.first > b.first; };
+    dyb::ordered_circular_list<item, decltype(by_first)> desc(by_first);
+    desc.insert(item(1, 0));
+    desc.insert(item(3, 0));
+    desc.insert(item(1, 1));
+    desc.insert(item(2, 0));
+    desc.insert(item(3, 1));
+    std::vector<item> expected = { item(3, 0), item(3, 1), item(2, 0), item(1, 0), item(1, 1) };
+    TEST(equal(begin(desc), end(desc), begin(expected)));
+}
+
+void test_ordered_bound()
+{
+    cout << "test_ordered_bound" << endl;
+    dyb::ordered_circular_list<int> ol = { 1, 3, 3, 5 };
+    TEST(ol.lower_bound(3) == ++begin(ol));
+    TEST(*ol.finger() == 3);
+    TEST(ol.upper_bound(3) == ++(++(++begin(ol))));
+    TEST(ol.lower_bound(0) == begin(ol));
+    TEST(ol.lower_bound(6) == end(ol));
+    TEST(*ol.upper_bound(4) == 5);
+
+    TEST(*ol.lower_bound(ol.loop_begin(), ol.loop_end(), 2) == 3);
+    TEST(*ol.upper_bound(ol.loop_begin(), ol.loop_end(), 3) == 5);
+    TEST(ol.upper_bound(ol.loop_begin(), ol.loop_end(), 5) == end(ol));
+
+    ol.erase(ol.finger());
+    TEST(equal(begin(ol), end(ol), begin({ 1, 3, 3 })));
+    TEST(ol.finger() == end(ol));
+    ol.insert(2);
+    TEST(equal(begin(ol), end(ol), begin({ 1, 2, 3, 3 })));
+}
+
+void test_ordered_merge()
+{
+    cout << "test_ordered_merge" << endl;
+    dyb::ordered_circular_list<int> ol;
+    std::vector<int> src = { 2, 4, 6 };
+    ol.merge(begin(src), end(src));
+    TEST(equal(begin(ol), end(ol), begin({ 2, 4, 6 })));
+    src = { 0, 1, 4, 5, 7, 8 };
+    ol.merge(begin(src), end(src));
+    TEST(ol.size() == 9);
+    TEST(equal(begin(ol), end(ol), begin({ 0, 1, 2, 4, 4, 5, 6, 7, 8 })));
+    TEST(*ol.finger() == 8);
+
+    dyb::ordered_circular_list<int> copy = ol;
+    TEST(copy.finger() == end(copy));
+    copy.insert(3);
+    TEST(equal(begin(copy), end(copy), begin({ 0, 1, 2, 3, 4, 4, 5, 6, 7, 8 })));
+    TEST(ol.size() == 9);
+}
+
+// ring_serialization
+void test_save_load()
+{
+    cout << "test_save_load" << endl;
+    circular_list<int> cl;
+    for (int i = 0; i < 3000; i++) cl.insert(end(cl), i);
+    std::stringstream ss;
+    TEST(dyb::save(cl, ss));
+    circular_list<int> loaded = { 7 };
+    TEST(dyb::load(loaded, ss));
+    TEST(loaded.size() == 3000);
+    TEST(equal(begin(loaded), end(loaded), begin(cl)));
+
+    // saved from the middle of the ring, loop_begin() is restored
+    circular_list<int> small = { 0, 1, 2, 3, 4 };
+    std::stringstream mid;
+    const circular_list<int> & csmall = small;
+    TEST(dyb::save(csmall, mid, ++(++csmall.loop_begin())));
+    TEST(mid.str().size() == 28 + 5 * sizeof(int));
+    TEST(dyb::load(loaded, mid));
+    TEST(equal(begin(loaded), end(loaded), begin({ 0, 1, 2, 3, 4 })));
+
+    // head_index in the middle of several chunks
+    std::stringstream far;
+    auto start = cl.loop_begin();
+    for (int i = 0; i < 1500; i++) ++start;
+    TEST(dyb::save(cl, far, start));
+    TEST(dyb::load(loaded, far));
+    TEST(loaded.size() == 3000);
+    TEST(equal(begin(loaded), end(loaded), begin(cl)));
+
+    // a start on a dead node stands for the next live one, dead nodes are not saved
+    circular_list<int> deferred = { 0, 1, 2, 3, 4 };
+    deferred.set_deferred_erase(true);
+    auto dead = cl_find(deferred, 2);
+    deferred.erase(dead);
+    std::stringstream skipped;
+    TEST(dyb::save(deferred, skipped, dead));
+    TEST(dyb::load(loaded, skipped));
+    TEST(equal(begin(loaded), end(loaded), begin({ 0, 1, 3, 4 })));
+
+    // empty list and bad data
+    std::stringstream empty;
+    TEST(dyb::save(circular_list<int>(), empty));
+    TEST(dyb::load(loaded, empty));
+    TEST(loaded.size() == 0);
+    std::stringstream bad("not a ring at all, definitely not");
+    TEST(!dyb::load(loaded, bad));
+    std::stringstream wrong_type;
+    dyb::save(small, wrong_type);
+    circular_list<double> d;
+    TEST(!dyb::load(d, wrong_type));
+}
+
+void test_ring_reader()
+{
+    cout << "test_ring_reader" << endl;
+    circular_list<int> cl = { 0, 1, 2, 3 };
+    std::stringstream ss;
+    dyb::save(cl, ss, ++cl.loop_begin());
+    dyb::ring_reader<int> reader(ss);
+    TEST(reader.valid());
+    TEST(reader.size() == 4);
+    TEST(reader.head_index() == 3);
+    std::vector<int> values;
+    int n = 0;
+    while (reader.next(n)) values.push_back(n);
+    TEST(equal(begin(values), end(values), begin({ 1, 2, 3, 0 })));
+
+    std::stringstream bad("xx");
+    dyb::ring_reader<int> bad_reader(bad);
+    TEST(!bad_reader.valid());
+    TEST(bad_reader.size() == 0);
+    TEST(bad_reader.head_index() == 0);
+    TEST(!bad_reader.next(n));
+
+    // the header decodes but the element size does not match
+    circular_list<double> doubles = { 0.5, 1.5, 2.5 };
+    std::stringstream wrong_type;
+    dyb::save(doubles, wrong_type, ++doubles.loop_begin());
+    dyb::ring_reader<int> wrong_reader(wrong_type);
+    TEST(!wrong_reader.valid());
+    TEST(wrong_reader.size() == 0);
+    TEST(wrong_reader.head_index() == 0);
+}
+
+#ifndef _WIN32
+void test_save_load_fd()
+{
+    cout << "test_save_load_fd" << endl;
+    circular_list<int> cl;
+    for (int i = 0; i < 2500; i++) cl.insert(end(cl), i);
+    FILE * file = std::tmpfile();
+    TEST(file != nullptr);
+    int fd = fileno(file);
+    TEST(dyb::save(cl, fd, ++cl.loop_begin()));
+    lseek(fd, 0, SEEK_SET);
+    circular_list<int> loaded;
+    TEST(dyb::load(loaded, fd));
+    TEST(equal(begin(loaded), end(loaded), begin(cl)));
+    TEST(loaded.size() == 2500);
+    lseek(fd, 0, SEEK_SET);
+    dyb::ring_reader<int> reader(fd);
+    int n = 0;
+    TEST(reader.next(n) && n == 1);
+    std::fclose(file);
+}
+#endif
+
 int main()
 {
     // core function
@@ -298,6 +1094,13 @@ int main()
     test_insert_loop_iter();
     test_erase();
     test_erase_loop_iter();
+    test_insert_range();
+    test_erase_if();
+    test_erase_if_loop_iter();
+    test_for_each_erase();
+    test_splice();
+    test_deferred_erase();
+    test_deferred_erase_threshold();
     test_constructor_operator();
     test_common_iter_const();
     test_loop_iter_const();
@@ -306,6 +1109,41 @@ int main()
     test_adjacent_find();
     test_for_each();
     test_for_adjacent();
+    test_for_window();
+    test_for_window_fixed();
+    test_window_reduce();
+
+    // ring_scheduler
+    test_ring_scheduler_round_robin();
+    test_ring_scheduler_steal();
+    test_ring_scheduler_queue_order();
+
+    // sharded_circular_list
+    test_sharded_next();
+    test_sharded_erase_if_cursor();
+    test_sharded_rebalance();
+    test_sharded_concurrent_insert();
+
+    // forward_circular_list
+    test_forward_push_pop();
+    test_forward_insert_erase_after();
+    test_forward_iter_algorithm();
+
+    // polygon_ring
+    test_polygon_ring_kernels();
+    test_polygon_ring_vs_for_adjacent();
+
+    // ordered_circular_list
+    test_ordered_insert();
+    test_ordered_bound();
+    test_ordered_merge();
+
+    // ring_serialization
+    test_save_load();
+    test_ring_reader();
+#ifndef _WIN32
+    test_save_load_fd();
+#endif
 
     cout << "all tests passed" << endl;
     return 0;
@@ -0,0 +1,220 @@
+#ifndef DYB_ORDERED_CIRCULAR_LIST
+#define DYB_ORDERED_CIRCULAR_LIST
+
+#include <functional>
+#include <initializer_list>
+
+#include "circle_list.h"
+#include "debug.h"
+
+
+// ordered_circular_list keeps a circular_list sorted by Compare:
+// walking from loop_begin() (the smallest element) to the node before it (the largest one)
+// the elements never decrease, and equal elements keep their insertion order.
+
+// finger search :
+// The list remembers the node touched by the last insert or search, the finger.
+// A new search starts from the finger (or from the hint given by the caller)
+// and walks forward with next or backward with prev, whichever way the element lies,
+// so it costs O(distance from the finger) instead of O(n) from the head.
+// Linking the new node is O(1), no existence check is run on the hint.
+
+
+namespace dyb
+{
+    template<class EleType, class Compare = std::less<EleType>>
+    class ordered_circular_list
+    {
+    public:
+        typedef circular_list<EleType> list_type;
+        typedef typename list_type::node node;
+        typedef typename list_type::iterator iterator;
+        typedef typename list_type::const_iterator const_iterator;
+        typedef typename list_type::common_iter common_iter;
+        typedef typename list_type::const_common_iter const_common_iter;
+        typedef typename list_type::loop_iter loop_iter;
+        typedef typename list_type::const_loop_iter const_loop_iter;
+
+        explicit ordered_circular_list(Compare comp = Compare())
+            : _comp(comp)
+        {
+        }
+
+        ordered_circular_list(std::initializer_list<EleType> _initList, Compare comp = Compare())
+            : _comp(comp)
+        {
+            for (auto & ele : _initList)
+            {
+                insert(ele);
+            }
+        }
+
+        ordered_circular_list(const ordered_circular_list & other)
+            : _list(other._list), _comp(other._comp), _finger(nullptr)
+        {
+        }
+
+        ordered_circular_list(ordered_circular_list && other)
+            : _list(std::move(other._list)), _comp(other._comp), _finger(other._finger)
+        {
+            other._finger = nullptr;
+        }
+
+        ordered_circular_list & operator = (const ordered_circular_list & other)
+        {
+            DEBUGCHECK(this != &other, "assignment to self");
+            _list = other._list;
+            _comp = other._comp;
+            _finger = nullptr;
+            return *this;
+        }
+
+        ordered_circular_list & operator = (ordered_circular_list && other)
+        {
+            DEBUGCHECK(this != &other, "assignment to self");
+            _list = std::move(other._list);
+            _comp = other._comp;
+            _finger = other._finger;
+            other._finger = nullptr;
+            return *this;
+        }
+
+        // insert after the equal elements, searching from the finger
+        loop_iter insert(const EleType & element)
+        {
+            return insert(loop_iter(_finger), element);
+        }
+        // same as above but searching from hint, hint can be null loop_iter
+        loop_iter insert(loop_iter hint, const EleType & element)
+        {
+            node * p = new node(element);
+            if (_list.head == nullptr)
+            {
+                _list.link(nullptr, p, p, 1);
+            }
+            else
+            {
+                bool past_tail = false;
+                node * location = locate(hint.get(), past_tail,
+                    [this, &element](const EleType & e){ return !_comp(element, e); });
+                _list.link(past_tail ? nullptr : location, p, p, 1);
+            }
+            _finger = p;
+            return loop_iter(p);
+        }
+
+        // Merge the sorted range [first, last) in one lap over the list,
+        // the elements are inserted after the equal ones already in the list.
+        template<class InputIt>
+        void merge(InputIt first, InputIt last)
+        {
+            if (first == last) return;
+            node * inserted = nullptr;
+            node * p = _list.head;
+            bool past_tail = p == nullptr;
+            for (; first != last; ++first)
+            {
+                DEBUGCHECK(inserted == nullptr || !_comp(*first, inserted->_ele),
+                    "ordered_circular_list::merge: range is not sorted");
+                while (!past_tail && !_comp(*first, p->_ele))
+                {
+                    p = p->next;
+                    past_tail = p == _list.head;
+                }
+                inserted = new node(*first);
+                _list.link(past_tail ? nullptr : p, inserted, inserted, 1);
+            }
+            _finger = inserted;
+        }
+
+        // the first element not less than element, or end(), searching from the finger
+        common_iter lower_bound(const EleType & element)
+        {
+            return bound([this, &element](const EleType & e){ return _comp(e, element); });
+        }
+        // the first element greater than element, or end(), searching from the finger
+        common_iter upper_bound(const EleType & element)
+        {
+            return bound([this, &element](const EleType & e){ return !_comp(element, e); });
+        }
+
+        // Linear search over the loop range [first, last) like circular_list::find_if,
+        // return null loop_iter when not found.
+        loop_iter lower_bound(loop_iter first, loop_iter last, const EleType & element)
+        {
+            return _list.find_if(first, last, [this, &element](const EleType & e){ return !_comp(e, element); });
+        }
+        loop_iter upper_bound(loop_iter first, loop_iter last, const EleType & element)
+        {
+            return _list.find_if(first, last, [this, &element](const EleType & e){ return _comp(element, e); });
+        }
+
+        common_iter erase(common_iter location)
+        {
+            if (location.get() == _finger) _finger = nullptr;
+            return _list.erase(location);
+        }
+        loop_iter erase(loop_iter location)
+        {
+            if (location.get() == _finger) _finger = nullptr;
+            return _list.erase(location);
+        }
+
+        void clear()
+        {
+            _list.clear();
+            _finger = nullptr;
+        }
+        size_t size() const { return _list.size(); }
+        loop_iter finger() { return loop_iter(_finger); }
+
+        common_iter begin() { return _list.begin(); }
+        common_iter end() { return _list.end(); }
+        const_common_iter begin() const { return _list.begin(); }
+        const_common_iter end() const { return _list.end(); }
+
+        loop_iter loop_begin() { return _list.loop_begin(); }
+        loop_iter loop_end() { return _list.loop_end(); }
+        const_loop_iter loop_begin() const { return _list.loop_begin(); }
+        const_loop_iter loop_end() const { return _list.loop_end(); }
+
+    private:
+        // Return the first node, counting from head, for which goes_before is false,
+        // past_tail is set when there is no such node (the returned node is then head).
+        // goes_before must be true for a prefix of the list and false for the rest.
+        template<class Pred>
+        node * locate(node * start, bool & past_tail, Pred goes_before)
+        {
+            node * head = _list.head;
+            node * p = start == nullptr ? head : start;
+            past_tail = false;
+            if (goes_before(p->_ele))
+            {
+                do p = p->next; while (p != head && goes_before(p->_ele));
+                past_tail = p == head;
+            }
+            else
+            {
+                while (p != head && !goes_before(p->prev->_ele)) p = p->prev;
+            }
+            return p;
+        }
+
+        template<class Pred>
+        common_iter bound(Pred goes_before)
+        {
+            if (_list.head == nullptr) return end();
+            bool past_tail = false;
+            node * p = locate(_finger, past_tail, goes_before);
+            if (past_tail) return end();
+            _finger = p;
+            return common_iter(_list.head, p);
+        }
+
+        list_type _list;
+        Compare _comp;
+        node * _finger = nullptr;
+    };
+}
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef DYB_POLYGON_RING
+#define DYB_POLYGON_RING
+
+#include <array>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <initializer_list>
+
+#include "debug.h"
+
+
+// polygon_ring stores the vertices of a closed polygon as structure-of-arrays,
+// one contiguous array per coordinate, instead of one heap node per point.
+// Like loop_iterator, vertex access wraps around: vertex(size()) is vertex(0),
+// and the edges are (0, 1), (1, 2) ... (n - 1, 0), the same pairs dyb::for_adjacent visits on a ring.
+
+// kernels :
+// Every kernel walks the arrays linearly over the n - 1 edges which do not wrap,
+// and handles the closing edge (n - 1, 0) on its own,
+// so the main loops have no modulo or branch on the index and can be vectorized by the compiler.
+// The edge crossing test of contains has no branch and no division.
+// perimeter and edge_lengths call sqrt per edge, so their loops are only vectorized
+// when sqrt does not have to set errno (-fno-math-errno for gcc and clang).
+// signed_area, contains and winding use the first two coordinates.
+
+
+namespace dyb
+{
+    template<class T, size_t Dims>
+    class polygon_ring
+    {
+        static_assert(std::is_floating_point<T>::value, "polygon_ring: T must be a floating point type");
+        static_assert(Dims >= 2, "polygon_ring: at least two dimensions are required");
+    public:
+        typedef std::array<T, Dims> point;
+
+        polygon_ring() = default;
+
+        polygon_ring(std::initializer_list<point> _initList)
+        {
+            reserve(_initList.size());
+            for (auto & p : _initList)
+            {
+                push_back(p);
+            }
+        }
+
+        void push_back(const point & p)
+        {
+            for (size_t d = 0; d < Dims; d++)
+                _coords[d].push_back(p[d]);
+        }
+        void reserve(size_t n)
+        {
+            for (auto & c : _coords)
+                c.reserve(n);
+        }
+        void clear()
+        {
+            for (auto & c : _coords)
+                c.clear();
+        }
+        size_t size() const { return _coords[0].size(); }
+
+        // index wraps around
+        point vertex(size_t i) const
+        {
+            DEBUGCHECK(size() != 0, "polygon_ring::vertex: empty polygon_ring");
+            i %= size();
+            point p;
+            for (size_t d = 0; d < Dims; d++)
+                p[d] = _coords[d][i];
+            return p;
+        }
+        // contiguous array of the coordinate dim of all vertices
+        const T * coords(size_t dim) const { return _coords[dim].data(); }
+        T * coords(size_t dim) { return _coords[dim].data(); }
+
+        // positive when the vertices are counterclockwise
+        T signed_area() const
+        {
+            size_t n = size();
+            if (n < 3) return T(0);
+            const T * x = coords(0);
+            const T * y = coords(1);
+            T sum = T(0);
+            for (size_t i = 0; i + 1 < n; i++)
+                sum += x[i] * y[i + 1] - x[i + 1] * y[i];
+            sum += x[n - 1] * y[0] - x[0] * y[n - 1];
+            return sum / T(2);
+        }
+
+        // 1 for counterclockwise, -1 for clockwise, 0 for degenerate
+        int winding() const
+        {
+            T area = signed_area();
+            return area > T(0) ? 1 : (area < T(0) ? -1 : 0);
+        }
+
+        T perimeter() const
+        {
+            size_t n = size();
+            if (n < 2) return T(0);
+            T sum = T(0);
+            for (size_t i = 0; i + 1 < n; i++)
+                sum += std::sqrt(squared_distance(i, i + 1));
+            return sum + std::sqrt(squared_distance(n - 1, 0));
+        }
+
+        // even-odd rule, points on the boundary may be reported either way
+        bool contains(const point & p) const
+        {
+            size_t n = size();
+            if (n < 3) return false;
+            const T * x = coords(0);
+            const T * y = coords(1);
+            int crossings = 0;
+            for (size_t i = 0; i + 1 < n; i++)
+                crossings += crosses(x[i], y[i], x[i + 1], y[i + 1], p[0], p[1]);
+            crossings += crosses(x[n - 1], y[n - 1], x[0], y[0], p[0], p[1]);
+            return (crossings & 1) != 0;
+        }
+
+        // out[d][i] = vertex(i + 1)[d] - vertex(i)[d], out[d] is resized to size()
+        void edge_vectors(std::array<std::vector<T>, Dims> & out) const
+        {
+            size_t n = size();
+            for (size_t d = 0; d < Dims; d++)
+            {
+                out[d].resize(n);
+                if (n == 0) continue;
+                const T * c = coords(d);
+                T * e = out[d].data();
+                for (size_t i = 0; i + 1 < n; i++)
+                    e[i] = c[i + 1] - c[i];
+                e[n - 1] = c[0] - c[n - 1];
+            }
+        }
+
+        // out[i] = length of the edge (i, i + 1), out is resized to size()
+        void edge_lengths(std::vector<T> & out) const
+        {
+            size_t n = size();
+            out.resize(n);
+            if (n == 0) return;
+            for (size_t i = 0; i + 1 < n; i++)
+                out[i] = std::sqrt(squared_distance(i, i + 1));
+            out[n - 1] = std::sqrt(squared_distance(n - 1, 0));
+        }
+
+        void translate(const point & offset)
+        {
+            for (size_t d = 0; d < Dims; d++)
+            {
+                T * c = coords(d);
+                T o = offset[d];
+                for (size_t i = 0, n = size(); i < n; i++)
+                    c[i] += o;
+            }
+        }
+
+        void scale(T factor)
+        {
+            for (auto & c : _coords)
+                for (auto & v : c)
+                    v *= factor;
+        }
+
+    private:
+        T squared_distance(size_t i, size_t j) const
+        {
+            T sum = T(0);
+            for (size_t d = 0; d < Dims; d++)
+            {
+                T diff = _coords[d][j] - _coords[d][i];
+                sum += diff * diff;
+            }
+            return sum;
+        }
+
+        // Whether the edge (x0, y0) - (x1, y1) crosses the ray going from (px, py) to +x.
+        // px < x0 + (py - y0) * (x1 - x0) / dy is tested multiplied by dy, which flips it when dy < 0,
+        // so there is no division, and both tests are combined with & instead of a branch.
+        static int crosses(T x0, T y0, T x1, T y1, T px, T py)
+        {
+            bool straddle = (y0 > py) != (y1 > py);
+            T dy = y1 - y0;
+            bool left = ((px - x0) * dy < (py - y0) * (x1 - x0)) != (dy < T(0));
+            return static_cast<int>(straddle & left);
+        }
+
+        std::array<std::vector<T>, Dims> _coords;
+    };
+}
+
+#endif
@@ -0,0 +1,253 @@
+#ifndef DYB_RING_SCHEDULER
+#define DYB_RING_SCHEDULER
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "circle_list.h"
+#include "debug.h"
+
+
+// ring_scheduler runs tasks on a fixed number of worker threads.
+// Tasks are submitted grouped in runnable queues.
+// Every worker owns a circular_list of runnable queues and a loop_iterator cursor walking it:
+// the worker runs the front task of the queue under the cursor and moves the cursor forward,
+// so all the queues of a worker are served round-robin, one task each per lap.
+// A queue is erased from the ring once it runs dry,
+// and a new queue is inserted right before the cursor, which puts it at the end of the current lap.
+
+// A queue is busy while one of its tasks is running, it is neither served nor stolen until that task returns,
+// so the tasks of one queue run one at a time and in order.
+
+// work stealing :
+// When the ring of a worker is empty, it walks the other workers
+// and splices the back half (relative to the victim's cursor) of the first ring holding at least two queues
+// into its own ring. The nodes are moved, not copied, so stealing costs one lap over the stolen segment.
+// The cursors and the segment bounds are known to be in their rings,
+// so insert and splice go through circular_list's unchecked link path (ring_scheduler is a friend of it)
+// and never walk a whole ring under a worker's mutex.
+// The victim keeps the queue under its cursor, and the stolen segment stops before the busy queue, if any.
+
+// idle workers :
+// A worker which finds nothing to run or steal sleeps until the work generation changes.
+// The generation is bumped by submit, and by a worker releasing a queue while others sleep,
+// since that queue may be the only stealable one.
+
+
+namespace dyb
+{
+    class ring_scheduler
+    {
+    public:
+        typedef std::function<void()> task;
+        typedef std::deque<task> task_queue;
+
+        explicit ring_scheduler(size_t worker_count = std::thread::hardware_concurrency())
+            : _workers(worker_count == 0 ? 1 : worker_count)
+        {
+            for (size_t i = 0; i < _workers.size(); i++)
+                _workers[i].thread = std::thread(&ring_scheduler::run, this, i);
+        }
+
+        ring_scheduler(const ring_scheduler &) = delete;
+        ring_scheduler & operator = (const ring_scheduler &) = delete;
+
+        // finish all submitted tasks before joining the workers
+        ~ring_scheduler()
+        {
+            wait();
+            {
+                std::lock_guard<std::mutex> lock(_idle_mutex);
+                _stop = true;
+                _idle_cv.notify_all();
+            }
+            for (auto & w : _workers)
+                w.thread.join();
+        }
+
+        // add a runnable queue to the ring of the next worker (round-robin among workers)
+        void submit(const task_queue & queue)
+        {
+            submit(queue, _next_worker++ % _workers.size());
+        }
+
+        void submit(const task_queue & queue, size_t worker_id)
+        {
+            DEBUGCHECK(worker_id < _workers.size(), "ring_scheduler::submit: invalid worker id");
+            if (queue.empty()) return;
+            _pending += queue.size();
+            worker & w = _workers[worker_id];
+            {
+                std::lock_guard<std::mutex> lock(w.mutex);
+                ring_type::node * p = new ring_type::node(runnable(queue));
+                w.ring.link(w.cursor.get(), p, p, 1);
+                if (w.ring.size() == 1) w.cursor = ring_type::loop_iter(p);
+            }
+            wake_up();
+        }
+
+        // a single task forms a queue of its own
+        void submit(task t)
+        {
+            submit(task_queue{ std::move(t) });
+        }
+
+        // block until every submitted task has finished
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(_idle_mutex);
+            _done_cv.wait(lock, [this]{ return _pending == 0; });
+        }
+
+        size_t worker_count() const { return _workers.size(); }
+
+    private:
+        struct runnable
+        {
+            task_queue tasks;
+            bool busy; // one of the tasks is running
+            explicit runnable(const task_queue & queue)
+                : tasks(queue), busy(false)
+            {
+            }
+        };
+        typedef circular_list<runnable> ring_type;
+
+        struct worker
+        {
+            std::mutex mutex;
+            ring_type ring;
+            ring_type::loop_iter cursor;
+            std::thread thread;
+        };
+
+        void run(size_t id)
+        {
+            worker & self = _workers[id];
+            task t;
+            ring_type::loop_iter running;
+            while (true)
+            {
+                if (pop(self, t, running))
+                {
+                    execute(self, t, running);
+                    continue;
+                }
+                // Count as sleeping before looking again, so that a release
+                // after the steal below has failed sees us and changes the generation.
+                ++_sleeping;
+                size_t seen = _generation;
+                if (pop(self, t, running) || (steal(id) && pop(self, t, running)))
+                {
+                    --_sleeping;
+                    execute(self, t, running);
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(_idle_mutex);
+                _idle_cv.wait(lock, [this, seen]{ return _stop || _generation != seen; });
+                --_sleeping;
+                if (_stop) return;
+            }
+        }
+
+        void execute(worker & self, task & t, ring_type::loop_iter running)
+        {
+            t();
+            t = nullptr;
+            release(self, running);
+            if (--_pending == 0)
+            {
+                std::lock_guard<std::mutex> lock(_idle_mutex);
+                _done_cv.notify_all();
+            }
+        }
+
+        void wake_up()
+        {
+            std::lock_guard<std::mutex> lock(_idle_mutex);
+            ++_generation;
+            _idle_cv.notify_all();
+        }
+
+        // Take the front task of the first idle queue from the cursor and move the cursor past it.
+        // running is set to the queue, which stays busy until release, or to null if the queue ran dry.
+        bool pop(worker & w, task & t, ring_type::loop_iter & running)
+        {
+            std::lock_guard<std::mutex> lock(w.mutex);
+            size_t n = w.ring.size();
+            for (size_t i = 0; i < n && w.cursor->busy; i++) ++w.cursor;
+            if (n == 0 || w.cursor->busy) return false;
+            task_queue & queue = w.cursor->tasks;
+            t = std::move(queue.front());
+            queue.pop_front();
+            if (queue.empty())
+            {
+                w.cursor = w.ring.erase(w.cursor);
+                running = ring_type::loop_iter();
+            }
+            else
+            {
+                w.cursor->busy = true;
+                running = w.cursor++;
+            }
+            return true;
+        }
+
+        // busy queues are never stolen, so running is still in the ring of w
+        void release(worker & w, ring_type::loop_iter running)
+        {
+            if (running == ring_type::loop_iter()) return;
+            bool stealable;
+            {
+                std::lock_guard<std::mutex> lock(w.mutex);
+                running->busy = false;
+                stealable = w.ring.size() >= 2;
+            }
+            if (stealable && _sleeping != 0) wake_up();
+        }
+
+        bool steal(size_t thief_id)
+        {
+            ring_type loot;
+            for (size_t i = 1; i < _workers.size() && loot.size() == 0; i++)
+            {
+                worker & victim = _workers[(thief_id + i) % _workers.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                size_t n = victim.ring.size();
+                if (n < 2) continue;
+                auto first = victim.cursor;
+                for (size_t k = 0; k < (n + 1) / 2; k++) ++first;
+                // stop before the busy queue, there is at most one per ring
+                auto last = first;
+                while (last != victim.cursor && !last->busy) ++last;
+                if (first == last) continue;
+                loot.transfer(nullptr, victim.ring, first.get(), last.get());
+            }
+            if (loot.size() == 0) return false;
+            worker & self = _workers[thief_id];
+            std::lock_guard<std::mutex> lock(self.mutex);
+            bool was_empty = self.ring.size() == 0;
+            auto p = self.ring.transfer(self.cursor.get(), loot, loot.head, loot.head);
+            if (was_empty) self.cursor = ring_type::loop_iter(p);
+            return true;
+        }
+
+        std::vector<worker> _workers;
+        std::atomic<size_t> _next_worker{ 0 };
+        std::atomic<size_t> _pending{ 0 };
+        std::atomic<size_t> _sleeping{ 0 };
+        std::atomic<size_t> _generation{ 0 }; // only incremented under _idle_mutex
+        bool _stop = false; // guarded by _idle_mutex
+        std::mutex _idle_mutex;
+        std::condition_variable _idle_cv;
+        std::condition_variable _done_cv;
+    };
+}
+
+#endif
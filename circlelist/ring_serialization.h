@@ -0,0 +1,321 @@
+#ifndef DYB_RING_SERIALIZATION
+#define DYB_RING_SERIALIZATION
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
+
+#include "circle_list.h"
+#include "debug.h"
+
+
+// Binary format of a saved circular_list, for trivially copyable EleType only :
+//     char     magic[4]     "DYBR"
+//     uint32_t version      format_version
+//     uint32_t element_size sizeof(EleType)
+//     uint64_t count        number of elements
+//     uint64_t head_index   position of loop_begin() among the elements
+//     EleType  elements[count]
+// All the fields use the byte order of the machine which saved them.
+// The elements are one contiguous block in ring order, starting from the position given to save,
+// so a ring can be saved from any node (the cursor of a scheduler for example)
+// and loading it still brings back the same loop_begin().
+// Dead nodes (see deferred erase) are not saved, a start on a dead node stands for the next live one.
+
+// save writes the elements straight from the nodes:
+// the fd version hands one iovec per node to writev (scatter-gather, no copy),
+// the ostream version packs them into a chunk buffer first.
+// load reads the block chunk by chunk and appends every chunk with one range insert,
+// the chunks from head_index on go to a second circular_list which is spliced in front at the end.
+// ring_reader visits the saved elements one by one without building a circular_list.
+
+// save and load return false on an I/O error or when the data is not in this format,
+// in which case the circular_list given to load is left empty.
+
+
+namespace dyb
+{
+    const uint32_t format_version = 1;
+
+    namespace detail
+    {
+        const char format_magic[4] = { 'D', 'Y', 'B', 'R' };
+        const size_t header_size = 4 + 4 + 4 + 8 + 8;
+        // elements per chunk buffer, also the number of iovec per writev call
+        const size_t chunk_size = 1024;
+
+        struct ring_header
+        {
+            uint32_t version;
+            uint32_t element_size;
+            uint64_t count;
+            uint64_t head_index;
+        };
+
+        inline void encode_header(const ring_header & h, char * buf)
+        {
+            std::memcpy(buf, format_magic, 4);
+            std::memcpy(buf + 4, &h.version, 4);
+            std::memcpy(buf + 8, &h.element_size, 4);
+            std::memcpy(buf + 12, &h.count, 8);
+            std::memcpy(buf + 20, &h.head_index, 8);
+        }
+
+        inline bool decode_header(const char * buf, ring_header & h)
+        {
+            if (std::memcmp(buf, format_magic, 4) != 0) return false;
+            std::memcpy(&h.version, buf + 4, 4);
+            std::memcpy(&h.element_size, buf + 8, 4);
+            std::memcpy(&h.count, buf + 12, 8);
+            std::memcpy(&h.head_index, buf + 20, 8);
+            return h.version == format_version && (h.count == 0 || h.head_index < h.count);
+        }
+
+        // read exactly size bytes
+        typedef std::function<bool(char * buf, size_t size)> byte_source;
+
+        inline byte_source stream_source(std::istream & is)
+        {
+            return [&is](char * buf, size_t size){
+                is.read(buf, size);
+                return static_cast<size_t>(is.gcount()) == size;
+            };
+        }
+
+#ifndef _WIN32
+        inline byte_source fd_source(int fd)
+        {
+            return [fd](char * buf, size_t size){
+                while (size != 0)
+                {
+                    ssize_t n = ::read(fd, buf, size);
+                    if (n <= 0) return false;
+                    buf += n;
+                    size -= static_cast<size_t>(n);
+                }
+                return true;
+            };
+        }
+
+        // writev until every iovec is written, iov is modified on partial writes
+        inline bool write_all(int fd, iovec * iov, int count)
+        {
+            while (count != 0)
+            {
+                ssize_t n = ::writev(fd, iov, count);
+                if (n < 0) return false;
+                while (count != 0 && static_cast<size_t>(n) >= iov->iov_len)
+                {
+                    n -= iov->iov_len;
+                    ++iov;
+                    --count;
+                }
+                if (count != 0)
+                {
+                    iov->iov_base = static_cast<char *>(iov->iov_base) + n;
+                    iov->iov_len -= n;
+                }
+            }
+            return true;
+        }
+#endif
+
+        template<class EleType, bool is_const>
+        ring_header make_header(const circular_list<EleType> & cl, loop_iterator<EleType, is_const> start)
+        {
+            ring_header h = { format_version, static_cast<uint32_t>(sizeof(EleType)), cl.size(), 0 };
+            if (cl.size() == 0) return h;
+            DEBUGCHECK(start.get() != nullptr, "save: invalid start");
+            start.skip_dead();
+            auto head = cl.loop_begin();
+            for (; start.get() != head.get(); ++start)
+            {
+                // a start out of cl would never reach its head
+                DEBUGCHECK(++h.head_index < h.count, "save: start is not in the circular_list");
+            }
+            return h;
+        }
+
+        template<class EleType>
+        bool load(circular_list<EleType> & cl, const byte_source & read)
+        {
+            static_assert(std::is_trivially_copyable<EleType>::value, "load: EleType must be trivially copyable");
+            cl.clear();
+            char buf[header_size];
+            ring_header h;
+            if (!read(buf, header_size) || !decode_header(buf, h) || h.element_size != sizeof(EleType))
+                return false;
+            std::vector<EleType> chunk;
+            // the elements from head_index on, they go in front of the first saved one at the end
+            circular_list<EleType> from_head;
+            for (uint64_t done = 0; done < h.count;)
+            {
+                // split the chunks at head_index
+                uint64_t limit = done < h.head_index ? h.head_index : h.count;
+                size_t n = static_cast<size_t>(std::min<uint64_t>(chunk_size, limit - done));
+                chunk.resize(n);
+                if (!read(reinterpret_cast<char *>(chunk.data()), n * sizeof(EleType)))
+                {
+                    cl.clear();
+                    return false;
+                }
+                circular_list<EleType> & target = done < h.head_index || h.head_index == 0 ? cl : from_head;
+                target.insert(target.end(), chunk.begin(), chunk.end());
+                done += n;
+            }
+            // one existence check for the whole load instead of one per chunk
+            if (from_head.size() != 0)
+                cl.splice(cl.loop_begin(), from_head, from_head.loop_begin(), from_head.loop_begin());
+            return true;
+        }
+    }
+
+    // save the elements of cl in ring order starting from start
+    template<class EleType, bool is_const>
+    bool save(const circular_list<EleType> & cl, std::ostream & os, loop_iterator<EleType, is_const> start)
+    {
+        static_assert(std::is_trivially_copyable<EleType>::value, "save: EleType must be trivially copyable");
+        start.skip_dead();
+        char buf[detail::header_size];
+        detail::encode_header(detail::make_header(cl, start), buf);
+        os.write(buf, detail::header_size);
+        std::vector<EleType> chunk;
+        chunk.reserve(std::min(detail::chunk_size, cl.size()));
+        for (size_t i = 0; i < cl.size(); ++i, ++start)
+        {
+            chunk.push_back(*start);
+            if (chunk.size() == detail::chunk_size || i + 1 == cl.size())
+            {
+                os.write(reinterpret_cast<const char *>(chunk.data()), chunk.size() * sizeof(EleType));
+                chunk.clear();
+            }
+        }
+        return static_cast<bool>(os);
+    }
+
+    template<class EleType>
+    bool save(const circular_list<EleType> & cl, std::ostream & os)
+    {
+        return save(cl, os, cl.loop_begin());
+    }
+
+    // replace the content of cl with the saved elements
+    template<class EleType>
+    bool load(circular_list<EleType> & cl, std::istream & is)
+    {
+        return detail::load(cl, detail::stream_source(is));
+    }
+
+#ifndef _WIN32
+    template<class EleType, bool is_const>
+    bool save(const circular_list<EleType> & cl, int fd, loop_iterator<EleType, is_const> start)
+    {
+        static_assert(std::is_trivially_copyable<EleType>::value, "save: EleType must be trivially copyable");
+        start.skip_dead();
+        char buf[detail::header_size];
+        detail::encode_header(detail::make_header(cl, start), buf);
+        iovec header = { buf, detail::header_size };
+        if (!detail::write_all(fd, &header, 1)) return false;
+        std::vector<iovec> iov;
+        iov.reserve(std::min(detail::chunk_size, cl.size()));
+        for (size_t i = 0; i < cl.size(); ++i, ++start)
+        {
+            iovec v = { const_cast<EleType *>(&*start), sizeof(EleType) };
+            iov.push_back(v);
+            if (iov.size() == detail::chunk_size || i + 1 == cl.size())
+            {
+                if (!detail::write_all(fd, iov.data(), static_cast<int>(iov.size()))) return false;
+                iov.clear();
+            }
+        }
+        return true;
+    }
+
+    template<class EleType>
+    bool save(const circular_list<EleType> & cl, int fd)
+    {
+        return save(cl, fd, cl.loop_begin());
+    }
+
+    template<class EleType>
+    bool load(circular_list<EleType> & cl, int fd)
+    {
+        return detail::load(cl, detail::fd_source(fd));
+    }
+#endif
+
+    // Visit saved elements in the order they were saved without building a circular_list.
+    // Check valid() after construction, the elements are read chunk by chunk.
+    template<class EleType>
+    class ring_reader
+    {
+        static_assert(std::is_trivially_copyable<EleType>::value, "ring_reader: EleType must be trivially copyable");
+    public:
+        explicit ring_reader(std::istream & is)
+            : _read(detail::stream_source(is))
+        {
+            read_header();
+        }
+
+#ifndef _WIN32
+        explicit ring_reader(int fd)
+            : _read(detail::fd_source(fd))
+        {
+            read_header();
+        }
+#endif
+
+        bool valid() const { return _valid; }
+        uint64_t size() const { return _header.count; }
+        // the position of loop_begin() of the saved circular_list
+        uint64_t head_index() const { return _header.head_index; }
+
+        // return false at the end of the elements or on a read error
+        bool next(EleType & out)
+        {
+            if (!_valid || _done == _header.count) return false;
+            if (_pos == _chunk.size())
+            {
+                size_t n = static_cast<size_t>(std::min<uint64_t>(detail::chunk_size, _header.count - _done));
+                _chunk.resize(n);
+                _pos = 0;
+                if (!_read(reinterpret_cast<char *>(_chunk.data()), n * sizeof(EleType)))
+                {
+                    _valid = false;
+                    return false;
+                }
+            }
+            out = _chunk[_pos++];
+            ++_done;
+            return true;
+        }
+
+    private:
+        void read_header()
+        {
+            char buf[detail::header_size];
+            _valid = _read(buf, detail::header_size) && detail::decode_header(buf, _header)
+                && _header.element_size == sizeof(EleType);
+            if (!_valid) _header = detail::ring_header();
+        }
+
+        detail::byte_source _read;
+        detail::ring_header _header = {};
+        bool _valid = false;
+        uint64_t _done = 0;
+        std::vector<EleType> _chunk;
+        size_t _pos = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef DYB_SHARDED_CIRCULAR_LIST
+#define DYB_SHARDED_CIRCULAR_LIST
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "circle_list.h"
+#include "debug.h"
+
+
+// sharded_circular_list splits one logical ring into several circular_list shards,
+// each one guarded by its own mutex and padded to its own cache line,
+// so threads working on different shards never touch a shared head or counter.
+
+// insert :
+// An element is inserted into the local shard of the calling thread (chosen by hashing the thread id)
+// right before the shard's cursor, i.e. at the end of the shard's current lap.
+// The cursor is always in its shard, so the node is linked without circular_list's existence check
+// and an insert costs O(1) under the shard's mutex.
+
+// next :
+// The shards are visited round-robin, one element per call,
+// and every shard walks its own ring with a loop_iterator cursor.
+// A thread starts from its local shard, and the turn counter it moves forward is kept in that shard,
+// so threads with different local shards take their turns independently.
+// An empty shard is skipped, so next() only fails when every shard is empty.
+
+// rebalance :
+// Moves nodes (splice, no reallocation) from the largest shards to the smallest ones
+// until the sizes differ by at most one. The nodes moved out of a shard are the ones
+// its cursor would reach last, the element under the cursor stays unless the shard is emptied.
+
+
+namespace dyb
+{
+    template<class EleType>
+    class sharded_circular_list
+    {
+    public:
+        typedef circular_list<EleType> shard_list;
+        typedef typename shard_list::loop_iter loop_iter;
+
+        explicit sharded_circular_list(size_t shard_count = std::thread::hardware_concurrency())
+            : _shards(shard_count == 0 ? 1 : shard_count)
+        {
+        }
+
+        sharded_circular_list(const sharded_circular_list &) = delete;
+        sharded_circular_list & operator = (const sharded_circular_list &) = delete;
+
+        void insert(const EleType & element)
+        {
+            insert(element, local_shard());
+        }
+
+        void insert(const EleType & element, size_t shard_id)
+        {
+            DEBUGCHECK(shard_id < _shards.size(), "sharded_circular_list::insert: invalid shard id");
+            shard & s = _shards[shard_id];
+            std::lock_guard<std::mutex> lock(s.mutex);
+            typename shard_list::node * p = new typename shard_list::node(element);
+            s.list.link(s.cursor.get(), p, p, 1);
+            if (s.list.size() == 1) s.cursor = loop_iter(p);
+        }
+
+        // copy the next element in round-robin order to out, return false when every shard is empty
+        bool next(EleType & out)
+        {
+            size_t local = local_shard();
+            std::atomic<size_t> & turn = _shards[local].turn;
+            size_t start = turn.fetch_add(1, std::memory_order_relaxed);
+            for (size_t i = 0; i < _shards.size(); i++)
+            {
+                shard & s = _shards[(local + start + i) % _shards.size()];
+                std::lock_guard<std::mutex> lock(s.mutex);
+                if (s.list.size() == 0) continue;
+                out = *s.cursor;
+                ++s.cursor;
+                // the turns of the skipped shards are not given to this one
+                if (i != 0) turn.store(start + i + 1, std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        }
+
+        // erase every element satisfying pred, return the number erased
+        size_t erase_if(function<bool(const EleType & e)> pred)
+        {
+            size_t erased = 0;
+            for (auto & s : _shards)
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                size_t n = s.list.size();
+                // the cursor moves to the first element it would reach which is kept,
+                // pred is called once per element
+                auto kept = s.cursor;
+                size_t skipped = 0;
+                while (skipped < n && pred(*kept))
+                {
+                    ++kept;
+                    ++skipped;
+                }
+                if (skipped == n)
+                {
+                    s.list.clear();
+                    s.cursor = loop_iter();
+                    erased += n;
+                    continue;
+                }
+                if (skipped != 0)
+                    erased += s.list.erase_if(s.cursor, kept, [](const EleType &){ return true; });
+                auto rest = kept;
+                if (++rest != kept)
+                    erased += s.list.erase_if(rest, kept, pred);
+                s.cursor = kept;
+            }
+            return erased;
+        }
+
+        void rebalance()
+        {
+            std::vector<std::unique_lock<std::mutex>> locks;
+            locks.reserve(_shards.size());
+            size_t total = 0;
+            for (auto & s : _shards) // always lock in index order
+            {
+                locks.emplace_back(s.mutex);
+                total += s.list.size();
+            }
+            shard_list pool;
+            for (size_t i = 0; i < _shards.size(); i++)
+            {
+                shard & s = _shards[i];
+                size_t n = s.list.size(), target = target_size(i, total);
+                if (n <= target) continue;
+                auto first = s.cursor;
+                for (size_t k = 0; k < target; k++) ++first;
+                pool.transfer(pool.head, s.list, first.get(), s.cursor.get());
+                if (target == 0) s.cursor = loop_iter();
+            }
+            for (size_t i = 0; i < _shards.size() && pool.size() != 0; i++)
+            {
+                shard & s = _shards[i];
+                size_t n = s.list.size(), target = target_size(i, total);
+                if (n >= target) continue;
+                auto last = pool.loop_begin();
+                for (size_t k = 0; k < target - n; k++) ++last;
+                auto p = s.list.transfer(s.cursor.get(), pool, pool.head, last.get());
+                if (n == 0) s.cursor = loop_iter(p);
+            }
+        }
+
+        size_t size() const
+        {
+            size_t total = 0;
+            for (auto & s : _shards)
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                total += s.list.size();
+            }
+            return total;
+        }
+
+        size_t shard_size(size_t shard_id) const
+        {
+            DEBUGCHECK(shard_id < _shards.size(), "sharded_circular_list::shard_size: invalid shard id");
+            std::lock_guard<std::mutex> lock(_shards[shard_id].mutex);
+            return _shards[shard_id].list.size();
+        }
+
+        size_t shard_count() const { return _shards.size(); }
+
+        size_t local_shard() const
+        {
+            return std::hash<std::thread::id>()(std::this_thread::get_id()) % _shards.size();
+        }
+
+    private:
+        static const size_t cache_line = 64;
+
+        struct shard
+        {
+            mutable std::mutex mutex;
+            shard_list list;
+            loop_iter cursor;
+            // turns of next() called by the threads whose local shard is this one
+            std::atomic<size_t> turn;
+            // the fields of two neighbouring shards never share a cache line
+            char padding[cache_line];
+
+            shard()
+                : turn(0)
+            {
+            }
+        };
+
+        // the first total % shard_count shards take one extra element
+        size_t target_size(size_t shard_id, size_t total) const
+        {
+            return total / _shards.size() + (shard_id < total % _shards.size() ? 1 : 0);
+        }
+
+        std::vector<shard> _shards;
+    };
+}
+
+#endif